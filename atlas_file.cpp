@@ -0,0 +1,284 @@
+
+#include "atlas_file.hpp"
+
+#include "trace.hpp"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_iostream.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// On-disk layout, all native-endian and 4-byte aligned:
+//   FileHeader
+//   FontRecord[font_count]
+//   PageRecord[page_count]
+//   GlyphRecord[glyph_count]
+//   page pixels, each page_size * page_size ARGB8888 at a 4 KiB boundary
+
+constexpr char file_magic[8] = {'S', 'D', 'L', 'T', 'T', 'F', 'A', 'T'};
+constexpr Uint32 file_byte_order = 0x01020304;
+constexpr Uint32 file_version = 1;
+constexpr Uint64 pixel_alignment = 4096;
+
+struct FileHeader {
+    char magic[8];
+    Uint32 byte_order;
+    Uint32 version;
+    Uint32 page_size;
+    Uint32 padding;
+    Uint32 font_count;
+    Uint32 page_count;
+    Uint32 glyph_count;
+    Uint32 reserved;
+};
+
+struct FontRecord {
+    char name[64];
+    float size;
+    Uint32 first_page;
+    Uint32 page_count;
+    Uint32 reserved;
+};
+
+struct PageRecord {
+    Uint32 first_glyph;
+    Uint32 glyph_count;
+    Uint32 used_height;
+    Uint32 reserved;
+    Uint64 pixels_offset;
+};
+
+// page is relative to the font's first page, or -1 for a glyph without ink.
+struct GlyphRecord {
+    Uint32 codepoint;
+    Sint32 page;
+    Sint32 slot[4];
+    Sint32 rect[4];
+    Sint32 offset_x;
+    Sint32 offset_y;
+    Sint32 advance;
+};
+
+static_assert(sizeof(FileHeader) == 40);
+static_assert(sizeof(FontRecord) == 80);
+static_assert(sizeof(PageRecord) == 24);
+static_assert(sizeof(GlyphRecord) == 52);
+
+Uint64 align_up(Uint64 offset) {
+    return (offset + pixel_alignment - 1) / pixel_alignment * pixel_alignment;
+}
+
+bool write_all(SDL_IOStream* io, const void* data, std::size_t size) {
+    return size == 0 || SDL_WriteIO(io, data, size) == size;
+}
+
+template <typename Record>
+bool read_record(const MappedFile& mapped, Uint64 offset, Record& record) {
+    if (offset > mapped.size() || mapped.size() - offset < sizeof(Record)) {
+        return false;
+    }
+    std::memcpy(&record, static_cast<const Uint8*>(mapped.data()) + offset, sizeof(Record));
+    return true;
+}
+
+} // namespace
+
+bool write_atlas_file(const std::string& path, const std::vector<AtlasFontSpec>& fonts, int page_size, int padding) {
+    TRACE_SCOPE("write_atlas_file");
+    std::vector<FontRecord> font_records;
+    std::vector<PageRecord> page_records;
+    std::vector<GlyphRecord> glyph_records;
+    std::vector<std::vector<AtlasPageImage>> baked;
+    bool ok = true;
+    for (const AtlasFontSpec& spec : fonts) {
+        if (spec.name.size() >= sizeof(FontRecord::name)) {
+            SDL_SetError("font name %s is too long", spec.name.c_str());
+            ok = false;
+            break;
+        }
+        TTF_Font* font = TTF_OpenFont(spec.path.c_str(), spec.size);
+        if (font == nullptr) {
+            ok = false;
+            break;
+        }
+        std::vector<AtlasPageImage> pages = build_atlas_pages(font, spec.ranges, page_size, padding);
+        TTF_CloseFont(font);
+
+        FontRecord record{};
+        std::memcpy(record.name, spec.name.data(), spec.name.size());
+        record.size = spec.size;
+        record.first_page = static_cast<Uint32>(page_records.size());
+        record.page_count = static_cast<Uint32>(pages.size());
+        font_records.push_back(record);
+        for (std::size_t page = 0; page < pages.size(); ++page) {
+            PageRecord page_record{};
+            page_record.first_glyph = static_cast<Uint32>(glyph_records.size());
+            page_record.glyph_count = static_cast<Uint32>(pages[page].glyphs.size());
+            page_record.used_height = static_cast<Uint32>(pages[page].packer.used_height());
+            page_records.push_back(page_record);
+            for (const PrebuiltGlyph& prebuilt : pages[page].glyphs) {
+                const Glyph& glyph = prebuilt.glyph;
+                glyph_records.push_back(GlyphRecord{
+                    prebuilt.codepoint,
+                    glyph.page >= 0 ? static_cast<Sint32>(page) : -1,
+                    {prebuilt.slot.x, prebuilt.slot.y, prebuilt.slot.w, prebuilt.slot.h},
+                    {glyph.rect.x, glyph.rect.y, glyph.rect.w, glyph.rect.h},
+                    glyph.offset_x,
+                    glyph.offset_y,
+                    glyph.advance,
+                });
+            }
+        }
+        baked.push_back(std::move(pages));
+    }
+
+    const Uint64 page_bytes = static_cast<Uint64>(page_size) * page_size * 4;
+    Uint64 offset = align_up(sizeof(FileHeader) + font_records.size() * sizeof(FontRecord) + page_records.size() * sizeof(PageRecord) + glyph_records.size() * sizeof(GlyphRecord));
+    for (PageRecord& page : page_records) {
+        page.pixels_offset = offset;
+        offset = align_up(offset + page_bytes);
+    }
+
+    SDL_IOStream* io = ok ? SDL_IOFromFile(path.c_str(), "wb") : nullptr;
+    if (io != nullptr) {
+        FileHeader header{};
+        std::memcpy(header.magic, file_magic, sizeof(file_magic));
+        header.byte_order = file_byte_order;
+        header.version = file_version;
+        header.page_size = static_cast<Uint32>(page_size);
+        header.padding = static_cast<Uint32>(padding);
+        header.font_count = static_cast<Uint32>(font_records.size());
+        header.page_count = static_cast<Uint32>(page_records.size());
+        header.glyph_count = static_cast<Uint32>(glyph_records.size());
+        ok = write_all(io, &header, sizeof(header)) &&
+             write_all(io, font_records.data(), font_records.size() * sizeof(FontRecord)) &&
+             write_all(io, page_records.data(), page_records.size() * sizeof(PageRecord)) &&
+             write_all(io, glyph_records.data(), glyph_records.size() * sizeof(GlyphRecord));
+        Uint64 written = sizeof(header) + font_records.size() * sizeof(FontRecord) + page_records.size() * sizeof(PageRecord) + glyph_records.size() * sizeof(GlyphRecord);
+        const std::vector<Uint8> zeros(pixel_alignment, 0);
+        std::size_t page_index = 0;
+        for (const auto& pages : baked) {
+            for (const AtlasPageImage& page : pages) {
+                const PageRecord& record = page_records[page_index++];
+                ok = ok && write_all(io, zeros.data(), record.pixels_offset - written);
+                for (int row = 0; ok && row < page_size; ++row) {
+                    ok = write_all(io, static_cast<const Uint8*>(page.surface->pixels) + row * page.surface->pitch, static_cast<std::size_t>(page_size) * 4);
+                }
+                written = record.pixels_offset + page_bytes;
+            }
+        }
+        ok = SDL_CloseIO(io) && ok;
+    } else {
+        ok = false;
+    }
+    for (auto& pages : baked) {
+        destroy_atlas_pages(pages);
+    }
+    return ok;
+}
+
+std::shared_ptr<AtlasFile> AtlasFile::open(const std::string& path) {
+    TRACE_SCOPE("AtlasFile::open");
+    std::shared_ptr<MappedFile> mapped = MappedFile::open(path);
+    if (mapped == nullptr) {
+        return nullptr;
+    }
+    std::shared_ptr<AtlasFile> file(new AtlasFile(std::move(mapped)));
+    if (!file->parse()) {
+        SDL_SetError("%s is not a valid atlas file", path.c_str());
+        return nullptr;
+    }
+    return file;
+}
+
+int AtlasFile::find_font(std::string_view name, float size) const {
+    for (std::size_t font = 0; font < fonts_.size(); ++font) {
+        if (fonts_[font].name == name && fonts_[font].size == size) {
+            return static_cast<int>(font);
+        }
+    }
+    return -1;
+}
+
+std::vector<AtlasPageImage> AtlasFile::pages(std::size_t font) const {
+    std::vector<AtlasPageImage> images;
+    const Font& record = fonts_[font];
+    for (std::size_t i = 0; i < record.page_count; ++i) {
+        const Page& page = pages_[record.first_page + i];
+        // The surface never writes to its pixels; adopt_page only reads them.
+        SDL_Surface* surface = SDL_CreateSurfaceFrom(page_size_, page_size_, SDL_PIXELFORMAT_ARGB8888, const_cast<void*>(page.pixels), page_size_ * 4);
+        if (surface == nullptr) {
+            break;
+        }
+        AtlasPageImage image{surface, SkylinePacker(page_size_, page.used_height), {}};
+        const auto first = glyphs_.begin() + static_cast<std::ptrdiff_t>(page.first_glyph);
+        image.glyphs.assign(first, first + static_cast<std::ptrdiff_t>(page.glyph_count));
+        images.push_back(std::move(image));
+    }
+    return images;
+}
+
+bool AtlasFile::parse() {
+    const MappedFile& mapped = *mapped_;
+    FileHeader header;
+    if (!read_record(mapped, 0, header) || std::memcmp(header.magic, file_magic, sizeof(file_magic)) != 0 ||
+        header.byte_order != file_byte_order || header.version != file_version || header.page_size == 0 || header.page_size > 16384) {
+        return false;
+    }
+    page_size_ = static_cast<int>(header.page_size);
+    padding_ = static_cast<int>(header.padding);
+    const Uint64 page_bytes = static_cast<Uint64>(header.page_size) * header.page_size * 4;
+
+    Uint64 offset = sizeof(FileHeader);
+    for (Uint32 i = 0; i < header.font_count; ++i, offset += sizeof(FontRecord)) {
+        FontRecord record;
+        if (!read_record(mapped, offset, record) || record.first_page > header.page_count || record.page_count > header.page_count - record.first_page) {
+            return false;
+        }
+        const std::size_t name_length = std::find(record.name, record.name + sizeof(record.name), '\0') - record.name;
+        fonts_.push_back(Font{std::string(record.name, name_length), record.size, record.first_page, record.page_count});
+    }
+    for (Uint32 i = 0; i < header.page_count; ++i, offset += sizeof(PageRecord)) {
+        PageRecord record;
+        if (!read_record(mapped, offset, record) || record.first_glyph > header.glyph_count || record.glyph_count > header.glyph_count - record.first_glyph ||
+            record.used_height > header.page_size || record.pixels_offset > mapped.size() || mapped.size() - record.pixels_offset < page_bytes) {
+            return false;
+        }
+        const void* pixels = static_cast<const Uint8*>(mapped.data()) + record.pixels_offset;
+        pages_.push_back(Page{pixels, static_cast<int>(record.used_height), record.first_glyph, record.glyph_count});
+    }
+    const auto size = static_cast<float>(header.page_size);
+    for (Uint32 i = 0; i < header.glyph_count; ++i, offset += sizeof(GlyphRecord)) {
+        GlyphRecord record;
+        if (!read_record(mapped, offset, record)) {
+            return false;
+        }
+        Glyph glyph;
+        glyph.page = record.page;
+        glyph.rect = SDL_Rect{record.rect[0], record.rect[1], record.rect[2], record.rect[3]};
+        glyph.uv = SDL_FRect{glyph.rect.x / size, glyph.rect.y / size, glyph.rect.w / size, glyph.rect.h / size};
+        glyph.offset_x = record.offset_x;
+        glyph.offset_y = record.offset_y;
+        glyph.advance = record.advance;
+        glyphs_.push_back(PrebuiltGlyph{record.codepoint, SDL_Rect{record.slot[0], record.slot[1], record.slot[2], record.slot[3]}, glyph});
+    }
+    return true;
+}
+
+bool adopt_atlas_file(GlyphAtlas& atlas, const AtlasFile& file, std::size_t font_index, TTF_Font* font) {
+    TRACE_SCOPE("adopt_atlas_file");
+    if (file.page_size() != atlas.config().page_size || file.font_size(font_index) != TTF_GetFontSize(font)) {
+        SDL_SetError("atlas file does not match the atlas page size or font size");
+        return false;
+    }
+    std::vector<AtlasPageImage> pages = file.pages(font_index);
+    bool adopted = false;
+    for (const AtlasPageImage& page : pages) {
+        adopted = atlas.adopt_page(font, page) || adopted;
+    }
+    destroy_atlas_pages(pages);
+    return adopted;
+}
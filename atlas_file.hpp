@@ -0,0 +1,88 @@
+
+#pragma once
+
+#include "atlas_page_builder.hpp"
+#include "glyph_atlas.hpp"
+#include "mapped_file.hpp"
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// One font to bake into an atlas file. name is what the runtime looks the
+// font up by, usually the font file's name.
+struct AtlasFontSpec {
+    std::string name;
+    std::string path;
+    float size = 0.0f;
+    std::vector<CodepointRange> ranges;
+};
+
+// Rasterizes every font in fonts with build_atlas_pages() and writes the
+// pages and their glyph tables to path. Returns false with the SDL error set
+// on failure. Needs TTF_Init() but no renderer.
+bool write_atlas_file(const std::string& path, const std::vector<AtlasFontSpec>& fonts, int page_size, int padding);
+
+// A baked atlas file, memory-mapped read-only. The file holds the page
+// pixels exactly as GlyphAtlas uploads them, so warming an atlas from it
+// costs one texture upload per page and no glyph rasterization.
+//
+// The format is native-endian and versioned; open() rejects files written
+// for another byte order or format version.
+class AtlasFile {
+public:
+    // Returns nullptr with the SDL error set if the file cannot be mapped or
+    // is not a valid atlas file.
+    static std::shared_ptr<AtlasFile> open(const std::string& path);
+
+    int page_size() const { return page_size_; }
+    int padding() const { return padding_; }
+    std::size_t font_count() const { return fonts_.size(); }
+    std::string_view font_name(std::size_t font) const { return fonts_[font].name; }
+    float font_size(std::size_t font) const { return fonts_[font].size; }
+
+    // Index of the font baked under name at size, or -1.
+    int find_font(std::string_view name, float size) const;
+
+    // The font's pages as images whose surfaces point straight into the
+    // mapping. Release them with destroy_atlas_pages() while this file is
+    // still alive.
+    std::vector<AtlasPageImage> pages(std::size_t font) const;
+
+private:
+    struct Font {
+        std::string name;
+        float size;
+        std::size_t first_page;
+        std::size_t page_count;
+    };
+
+    struct Page {
+        const void* pixels;
+        int used_height;
+        std::size_t first_glyph;
+        std::size_t glyph_count;
+    };
+
+    explicit AtlasFile(std::shared_ptr<MappedFile> mapped)
+        : mapped_(std::move(mapped)) {}
+
+    bool parse();
+
+    std::shared_ptr<MappedFile> mapped_;
+    int page_size_ = 0;
+    int padding_ = 0;
+    std::vector<Font> fonts_;
+    std::vector<Page> pages_;
+    std::vector<PrebuiltGlyph> glyphs_;
+};
+
+// Uploads a baked font's pages into atlas as glyphs of font, which must be
+// open at the size the font was baked at. Returns false if the sizes or the
+// atlas page size do not match or no page could be adopted.
+bool adopt_atlas_file(GlyphAtlas& atlas, const AtlasFile& file, std::size_t font_index, TTF_Font* font);
@@ -0,0 +1,71 @@
+
+#include "atlas_page_builder.hpp"
+
+#include "glyph_raster.hpp"
+
+#include <SDL3/SDL_log.h>
+
+namespace {
+
+bool start_page(std::vector<AtlasPageImage>& pages, int page_size) {
+    SDL_Surface* surface = SDL_CreateSurface(page_size, page_size, SDL_PIXELFORMAT_ARGB8888);
+    if (surface == nullptr) {
+        SDL_Log("build_atlas_pages: failed to create page: %s", SDL_GetError());
+        return false;
+    }
+    SDL_FillSurfaceRect(surface, nullptr, 0);
+    pages.push_back(AtlasPageImage{surface, SkylinePacker(page_size), {}});
+    return true;
+}
+
+} // namespace
+
+std::vector<AtlasPageImage> build_atlas_pages(TTF_Font* font, const std::vector<CodepointRange>& ranges, int page_size, int padding) {
+    std::vector<AtlasPageImage> pages;
+    std::vector<PrebuiltGlyph> blanks;
+    for (const CodepointRange& range : ranges) {
+        for (Uint64 next = range.first; next <= range.last; ++next) {
+            const auto codepoint = static_cast<Uint32>(next);
+            if (!TTF_FontHasGlyph(font, codepoint)) {
+                continue;
+            }
+            GlyphBitmap bitmap;
+            if (!rasterize_glyph(font, codepoint, bitmap)) {
+                continue;
+            }
+            if (bitmap.surface == nullptr) {
+                Glyph glyph;
+                glyph.advance = bitmap.advance;
+                blanks.push_back(PrebuiltGlyph{codepoint, SDL_Rect{0, 0, 0, 0}, glyph});
+                continue;
+            }
+            const int w = bitmap.ink.w + 2 * padding;
+            const int h = bitmap.ink.h + 2 * padding;
+            SDL_Rect slot;
+            if (pages.empty() || !pages.back().packer.pack(w, h, slot)) {
+                if (!start_page(pages, page_size) || !pages.back().packer.pack(w, h, slot)) {
+                    SDL_DestroySurface(bitmap.surface);
+                    continue;
+                }
+            }
+            AtlasPageImage& page = pages.back();
+            copy_glyph_ink(bitmap, page.surface->pixels, page.surface->pitch, slot.x + padding, slot.y + padding);
+            page.glyphs.push_back(PrebuiltGlyph{codepoint, slot, place_glyph(0, slot, bitmap, padding, page_size)});
+            SDL_DestroySurface(bitmap.surface);
+        }
+    }
+    if (!blanks.empty()) {
+        if (pages.empty() && !start_page(pages, page_size)) {
+            return pages;
+        }
+        pages.front().glyphs.insert(pages.front().glyphs.end(), blanks.begin(), blanks.end());
+    }
+    return pages;
+}
+
+void destroy_atlas_pages(std::vector<AtlasPageImage>& pages) {
+    for (AtlasPageImage& page : pages) {
+        SDL_DestroySurface(page.surface);
+    }
+    pages.clear();
+}
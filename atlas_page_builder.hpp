@@ -0,0 +1,22 @@
+
+#pragma once
+
+#include "glyph_atlas.hpp"
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <vector>
+
+// Inclusive range of codepoints, e.g. {0x20, 0x7E} for printable ASCII.
+struct CodepointRange {
+    Uint32 first;
+    Uint32 last;
+};
+
+// Rasterizes every codepoint in ranges that the font has into as few
+// page_size square images as possible, packed the same way GlyphAtlas packs
+// its own pages. Touches no renderer, so it may run on any thread that owns
+// the font. The caller destroys each image's surface.
+std::vector<AtlasPageImage> build_atlas_pages(TTF_Font* font, const std::vector<CodepointRange>& ranges, int page_size, int padding);
+
+void destroy_atlas_pages(std::vector<AtlasPageImage>& pages);
@@ -0,0 +1,96 @@
+
+#include "atlas_file.hpp"
+
+#include <SDL3/SDL_init.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Bakes glyph atlases offline so the app can warm its GlyphAtlas from a
+// file instead of rasterizing at startup:
+//
+//   atlas_tool [--page-size N] [--padding N] OUTPUT --font PATH SIZE RANGES...
+//
+// RANGES is a comma separated list of hex codepoints or ranges, e.g.
+// 20-7E,A0-FF,3000-303F. Each font is stored under its file name, which is
+// what AtlasFile::find_font() expects at runtime.
+
+namespace {
+
+bool parse_ranges(std::string_view text, std::vector<CodepointRange>& ranges) {
+    while (!text.empty()) {
+        const std::size_t comma = text.find(',');
+        const std::string item(text.substr(0, comma));
+        char* end = nullptr;
+        const unsigned long first = std::strtoul(item.c_str(), &end, 16);
+        unsigned long last = first;
+        if (*end == '-') {
+            last = std::strtoul(end + 1, &end, 16);
+        }
+        if (end == item.c_str() || *end != '\0' || last < first || last > 0x10FFFF) {
+            return false;
+        }
+        ranges.push_back(CodepointRange{static_cast<Uint32>(first), static_cast<Uint32>(last)});
+        text.remove_prefix(comma == std::string_view::npos ? text.size() : comma + 1);
+    }
+    return !ranges.empty();
+}
+
+std::string file_name(const std::string& path) {
+    const std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+void print_usage() {
+    std::cout<<"usage: atlas_tool [--page-size N] [--padding N] OUTPUT --font PATH SIZE RANGES..."<<std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int page_size = 1024;
+    int padding = 1;
+    const char* output = nullptr;
+    std::vector<AtlasFontSpec> fonts;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--page-size") == 0 && i + 1 < argc) {
+            page_size = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--padding") == 0 && i + 1 < argc) {
+            padding = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--font") == 0 && i + 3 < argc) {
+            AtlasFontSpec spec;
+            spec.path = argv[i + 1];
+            spec.name = file_name(spec.path);
+            spec.size = static_cast<float>(std::atof(argv[i + 2]));
+            if (spec.size <= 0.0f || !parse_ranges(argv[i + 3], spec.ranges)) {
+                std::cout<<"bad size or ranges for "<<spec.path<<std::endl;
+                return 1;
+            }
+            fonts.push_back(std::move(spec));
+            i += 3;
+        } else if (output == nullptr) {
+            output = argv[i];
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+    if (output == nullptr || fonts.empty() || page_size <= 0 || padding < 0) {
+        print_usage();
+        return 1;
+    }
+    SDL_Init(0);
+    TTF_Init();
+    const bool ok = write_atlas_file(output, fonts, page_size, padding);
+    if (!ok) {
+        std::cout<<"failed to write "<<output<<": "<<SDL_GetError()<<std::endl;
+    }
+    TTF_Quit();
+    SDL_Quit();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,363 @@
+
+#include "blit_kernels.hpp"
+
+#include <SDL3/SDL_cpuinfo.h>
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BLIT_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define BLIT_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(BLIT_HAVE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BLIT_TARGET_SSE2 __attribute__((target("sse2")))
+#define BLIT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BLIT_TARGET_SSE2
+#define BLIT_TARGET_AVX2
+#endif
+
+namespace {
+
+// Rounded x / 255 for x in [0, 255 * 255], exact.
+inline Uint32 div255(Uint32 x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// Blends one ARGB8888 source pixel, already expressed as its four channels,
+// over dst. The source alpha decides the mix; the output alpha is
+// a + dst_a * (1 - a).
+inline Uint32 blend_pixel(Uint32 b, Uint32 g, Uint32 r, Uint32 a, Uint32 dst) {
+    const Uint32 inv = 255 - a;
+    const Uint32 out_b = div255(b * a + (dst & 0xFF) * inv);
+    const Uint32 out_g = div255(g * a + ((dst >> 8) & 0xFF) * inv);
+    const Uint32 out_r = div255(r * a + ((dst >> 16) & 0xFF) * inv);
+    const Uint32 out_a = div255(255 * a + (dst >> 24) * inv);
+    return out_b | (out_g << 8) | (out_r << 16) | (out_a << 24);
+}
+
+inline Uint32 tinted_argb_pixel(Uint32 src, SDL_Color tint, Uint32 dst) {
+    const Uint32 b = div255((src & 0xFF) * tint.b);
+    const Uint32 g = div255(((src >> 8) & 0xFF) * tint.g);
+    const Uint32 r = div255(((src >> 16) & 0xFF) * tint.r);
+    const Uint32 a = div255((src >> 24) * tint.a);
+    return blend_pixel(b, g, r, a, dst);
+}
+
+// Coverage is treated as a white ARGB pixel with that alpha, so both source
+// kinds go through the same arithmetic in every kernel.
+inline Uint32 coverage_as_argb(Uint8 coverage) {
+    return (static_cast<Uint32>(coverage) << 24) | 0x00FFFFFFu;
+}
+
+Uint32* dst_row(Uint32* dst, int dst_pitch, int y) {
+    return reinterpret_cast<Uint32*>(reinterpret_cast<Uint8*>(dst) + y * dst_pitch);
+}
+
+const Uint32* argb_row(const Uint32* src, int src_pitch, int y) {
+    return reinterpret_cast<const Uint32*>(reinterpret_cast<const Uint8*>(src) + y * src_pitch);
+}
+
+void coverage_scalar(const Uint8* src, int src_pitch, Uint32* dst, int dst_pitch, int w, int h, SDL_Color tint) {
+    for (int y = 0; y < h; ++y) {
+        const Uint8* s = src + y * src_pitch;
+        Uint32* d = dst_row(dst, dst_pitch, y);
+        for (int x = 0; x < w; ++x) {
+            if (s[x] != 0) {
+                d[x] = tinted_argb_pixel(coverage_as_argb(s[x]), tint, d[x]);
+            }
+        }
+    }
+}
+
+void argb_scalar(const Uint32* src, int src_pitch, Uint32* dst, int dst_pitch, int w, int h, SDL_Color tint) {
+    for (int y = 0; y < h; ++y) {
+        const Uint32* s = argb_row(src, src_pitch, y);
+        Uint32* d = dst_row(dst, dst_pitch, y);
+        for (int x = 0; x < w; ++x) {
+            if ((s[x] >> 24) != 0) {
+                d[x] = tinted_argb_pixel(s[x], tint, d[x]);
+            }
+        }
+    }
+}
+
+#ifdef BLIT_HAVE_X86
+
+BLIT_TARGET_SSE2 inline __m128i div255_sse2(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Two pixels widened to 16-bit lanes: tint, then blend over dst.
+BLIT_TARGET_SSE2 inline __m128i blend_sse2(__m128i src, __m128i dst, __m128i tint) {
+    const __m128i color_mask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alpha_one = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i s = div255_sse2(_mm_mullo_epi16(src, tint));
+    const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    const __m128i color = _mm_or_si128(_mm_and_si128(s, color_mask), alpha_one);
+    return div255_sse2(_mm_add_epi16(_mm_mullo_epi16(color, a), _mm_mullo_epi16(dst, inv)));
+}
+
+BLIT_TARGET_SSE2 inline __m128i blend4_sse2(__m128i src, __m128i dst, __m128i tint) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = blend_sse2(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero), tint);
+    const __m128i hi = blend_sse2(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero), tint);
+    return _mm_packus_epi16(lo, hi);
+}
+
+BLIT_TARGET_SSE2 inline __m128i tint_sse2(SDL_Color tint) {
+    return _mm_set_epi16(tint.a, tint.r, tint.g, tint.b, tint.a, tint.r, tint.g, tint.b);
+}
+
+BLIT_TARGET_SSE2 void coverage_sse2(const Uint8* src, int src_pitch, Uint32* dst, int dst_pitch, int w, int h, SDL_Color tint) {
+    const __m128i tint16 = tint_sse2(tint);
+    const __m128i white = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i zero = _mm_setzero_si128();
+    for (int y = 0; y < h; ++y) {
+        const Uint8* s = src + y * src_pitch;
+        Uint32* d = dst_row(dst, dst_pitch, y);
+        int x = 0;
+        for (; x + 4 <= w; x += 4) {
+            Uint32 packed;
+            std::memcpy(&packed, s + x, 4);
+            if (packed == 0) {
+                continue;
+            }
+            const __m128i coverage = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(packed)), zero), zero);
+            const __m128i argb = _mm_or_si128(_mm_slli_epi32(coverage, 24), white);
+            auto* out = reinterpret_cast<__m128i*>(d + x);
+            _mm_storeu_si128(out, blend4_sse2(argb, _mm_loadu_si128(out), tint16));
+        }
+        for (; x < w; ++x) {
+            if (s[x] != 0) {
+                d[x] = tinted_argb_pixel(coverage_as_argb(s[x]), tint, d[x]);
+            }
+        }
+    }
+}
+
+BLIT_TARGET_SSE2 void argb_sse2(const Uint32* src, int src_pitch, Uint32* dst, int dst_pitch, int w, int h, SDL_Color tint) {
+    const __m128i tint16 = tint_sse2(tint);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    for (int y = 0; y < h; ++y) {
+        const Uint32* s = argb_row(src, src_pitch, y);
+        Uint32* d = dst_row(dst, dst_pitch, y);
+        int x = 0;
+        for (; x + 4 <= w; x += 4) {
+            const __m128i argb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + x));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(argb, alpha), _mm_setzero_si128())) == 0xFFFF) {
+                continue;
+            }
+            auto* out = reinterpret_cast<__m128i*>(d + x);
+            _mm_storeu_si128(out, blend4_sse2(argb, _mm_loadu_si128(out), tint16));
+        }
+        for (; x < w; ++x) {
+            if ((s[x] >> 24) != 0) {
+                d[x] = tinted_argb_pixel(s[x], tint, d[x]);
+            }
+        }
+    }
+}
+
+BLIT_TARGET_AVX2 inline __m256i div255_avx2(__m256i x) {
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+BLIT_TARGET_AVX2 inline __m256i blend_avx2(__m256i src, __m256i dst, __m256i tint) {
+    const __m256i color_mask = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+    const __m256i alpha_one = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    const __m256i s = div255_avx2(_mm256_mullo_epi16(src, tint));
+    const __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    const __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    const __m256i color = _mm256_or_si256(_mm256_and_si256(s, color_mask), alpha_one);
+    return div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(color, a), _mm256_mullo_epi16(dst, inv)));
+}
+
+// Unpack and pack both work per 128-bit lane, so pixel order survives.
+BLIT_TARGET_AVX2 inline __m256i blend8_avx2(__m256i src, __m256i dst, __m256i tint) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i lo = blend_avx2(_mm256_unpacklo_epi8(src, zero), _mm256_unpacklo_epi8(dst, zero), tint);
+    const __m256i hi = blend_avx2(_mm256_unpackhi_epi8(src, zero), _mm256_unpackhi_epi8(dst, zero), tint);
+    return _mm256_packus_epi16(lo, hi);
+}
+
+BLIT_TARGET_AVX2 inline __m256i tint_avx2(SDL_Color tint) {
+    return _mm256_set_epi16(tint.a, tint.r, tint.g, tint.b, tint.a, tint.r, tint.g, tint.b, tint.a, tint.r, tint.g, tint.b, tint.a, tint.r, tint.g, tint.b);
+}
+
+BLIT_TARGET_AVX2 void coverage_avx2(const Uint8* src, int src_pitch, Uint32* dst, int dst_pitch, int w, int h, SDL_Color tint) {
+    const __m256i tint16 = tint_avx2(tint);
+    const __m256i white = _mm256_set1_epi32(0x00FFFFFF);
+    for (int y = 0; y < h; ++y) {
+        const Uint8* s = src + y * src_pitch;
+        Uint32* d = dst_row(dst, dst_pitch, y);
+        int x = 0;
+        for (; x + 8 <= w; x += 8) {
+            Uint64 packed;
+            std::memcpy(&packed, s + x, 8);
+            if (packed == 0) {
+                continue;
+            }
+            const __m256i coverage = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + x)));
+            const __m256i argb = _mm256_or_si256(_mm256_slli_epi32(coverage, 24), white);
+            auto* out = reinterpret_cast<__m256i*>(d + x);
+            _mm256_storeu_si256(out, blend8_avx2(argb, _mm256_loadu_si256(out), tint16));
+        }
+        for (; x < w; ++x) {
+            if (s[x] != 0) {
+                d[x] = tinted_argb_pixel(coverage_as_argb(s[x]), tint, d[x]);
+            }
+        }
+    }
+}
+
+BLIT_TARGET_AVX2 void argb_avx2(const Uint32* src, int src_pitch, Uint32* dst, int dst_pitch, int w, int h, SDL_Color tint) {
+    const __m256i tint16 = tint_avx2(tint);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    for (int y = 0; y < h; ++y) {
+        const Uint32* s = argb_row(src, src_pitch, y);
+        Uint32* d = dst_row(dst, dst_pitch, y);
+        int x = 0;
+        for (; x + 8 <= w; x += 8) {
+            const __m256i argb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + x));
+            if (_mm256_testz_si256(argb, alpha)) {
+                continue;
+            }
+            auto* out = reinterpret_cast<__m256i*>(d + x);
+            _mm256_storeu_si256(out, blend8_avx2(argb, _mm256_loadu_si256(out), tint16));
+        }
+        for (; x < w; ++x) {
+            if ((s[x] >> 24) != 0) {
+                d[x] = tinted_argb_pixel(s[x], tint, d[x]);
+            }
+        }
+    }
+}
+
+#endif // BLIT_HAVE_X86
+
+#ifdef BLIT_HAVE_NEON
+
+// Exact rounded x / 255, narrowed to bytes.
+inline uint8x8_t div255_neon(uint16x8_t x) {
+    return vraddhn_u16(x, vrshrq_n_u16(x, 8));
+}
+
+// Eight deinterleaved pixels (ARGB8888 in memory is B, G, R, A).
+inline uint8x8x4_t blend8_neon(uint8x8x4_t src, uint8x8x4_t dst, uint8x8x4_t tint) {
+    uint8x8_t s[4];
+    for (int c = 0; c < 4; ++c) {
+        s[c] = div255_neon(vmull_u8(src.val[c], tint.val[c]));
+    }
+    const uint8x8_t a = s[3];
+    const uint8x8_t inv = vsub_u8(vdup_n_u8(255), a);
+    uint8x8x4_t out;
+    for (int c = 0; c < 3; ++c) {
+        out.val[c] = div255_neon(vmlal_u8(vmull_u8(s[c], a), dst.val[c], inv));
+    }
+    out.val[3] = div255_neon(vmlal_u8(vmull_u8(vdup_n_u8(255), a), dst.val[3], inv));
+    return out;
+}
+
+inline uint8x8x4_t tint_neon(SDL_Color tint) {
+    uint8x8x4_t t;
+    t.val[0] = vdup_n_u8(tint.b);
+    t.val[1] = vdup_n_u8(tint.g);
+    t.val[2] = vdup_n_u8(tint.r);
+    t.val[3] = vdup_n_u8(tint.a);
+    return t;
+}
+
+void coverage_neon(const Uint8* src, int src_pitch, Uint32* dst, int dst_pitch, int w, int h, SDL_Color tint) {
+    const uint8x8x4_t tint8 = tint_neon(tint);
+    for (int y = 0; y < h; ++y) {
+        const Uint8* s = src + y * src_pitch;
+        Uint32* d = dst_row(dst, dst_pitch, y);
+        int x = 0;
+        for (; x + 8 <= w; x += 8) {
+            const uint8x8_t coverage = vld1_u8(s + x);
+            if (vget_lane_u64(vreinterpret_u64_u8(coverage), 0) == 0) {
+                continue;
+            }
+            uint8x8x4_t argb;
+            argb.val[0] = vdup_n_u8(255);
+            argb.val[1] = vdup_n_u8(255);
+            argb.val[2] = vdup_n_u8(255);
+            argb.val[3] = coverage;
+            auto* out = reinterpret_cast<Uint8*>(d + x);
+            vst4_u8(out, blend8_neon(argb, vld4_u8(out), tint8));
+        }
+        for (; x < w; ++x) {
+            if (s[x] != 0) {
+                d[x] = tinted_argb_pixel(coverage_as_argb(s[x]), tint, d[x]);
+            }
+        }
+    }
+}
+
+void argb_neon(const Uint32* src, int src_pitch, Uint32* dst, int dst_pitch, int w, int h, SDL_Color tint) {
+    const uint8x8x4_t tint8 = tint_neon(tint);
+    for (int y = 0; y < h; ++y) {
+        const Uint32* s = argb_row(src, src_pitch, y);
+        Uint32* d = dst_row(dst, dst_pitch, y);
+        int x = 0;
+        for (; x + 8 <= w; x += 8) {
+            const uint8x8x4_t argb = vld4_u8(reinterpret_cast<const Uint8*>(s + x));
+            if (vget_lane_u64(vreinterpret_u64_u8(argb.val[3]), 0) == 0) {
+                continue;
+            }
+            auto* out = reinterpret_cast<Uint8*>(d + x);
+            vst4_u8(out, blend8_neon(argb, vld4_u8(out), tint8));
+        }
+        for (; x < w; ++x) {
+            if ((s[x] >> 24) != 0) {
+                d[x] = tinted_argb_pixel(s[x], tint, d[x]);
+            }
+        }
+    }
+}
+
+#endif // BLIT_HAVE_NEON
+
+const BlitKernels scalar_kernels{"scalar", coverage_scalar, argb_scalar};
+
+const BlitKernels& select_kernels() {
+#ifdef BLIT_HAVE_X86
+    static const BlitKernels avx2{"avx2", coverage_avx2, argb_avx2};
+    static const BlitKernels sse2{"sse2", coverage_sse2, argb_sse2};
+    if (SDL_HasAVX2()) {
+        return avx2;
+    }
+    if (SDL_HasSSE2()) {
+        return sse2;
+    }
+#endif
+#ifdef BLIT_HAVE_NEON
+    static const BlitKernels neon{"neon", coverage_neon, argb_neon};
+    if (SDL_HasNEON()) {
+        return neon;
+    }
+#endif
+    return scalar_kernels;
+}
+
+} // namespace
+
+const BlitKernels& blit_kernels() {
+    static const BlitKernels& kernels = select_kernels();
+    return kernels;
+}
+
+const BlitKernels& scalar_blit_kernels() {
+    return scalar_kernels;
+}
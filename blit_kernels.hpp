@@ -0,0 +1,23 @@
+
+#pragma once
+
+#include <SDL3/SDL_pixels.h>
+
+// Alpha-blend kernels for compositing glyphs onto SDL_PIXELFORMAT_ARGB8888
+// surfaces. The source is tinted by a colour and blended "over" a
+// straight-alpha destination. Pitches are in bytes and the caller has
+// already clipped the rectangle. Every implementation produces the same
+// bytes as the scalar one.
+struct BlitKernels {
+    const char* name;
+    // 8-bit coverage source: each byte is the glyph's alpha.
+    void (*coverage)(const Uint8* src, int src_pitch, Uint32* dst, int dst_pitch, int w, int h, SDL_Color tint);
+    // ARGB8888 source, e.g. TTF_RenderText_Blended output, modulated by tint.
+    void (*argb)(const Uint32* src, int src_pitch, Uint32* dst, int dst_pitch, int w, int h, SDL_Color tint);
+};
+
+// The fastest kernels this CPU supports (AVX2, SSE2, NEON or scalar),
+// picked on first use.
+const BlitKernels& blit_kernels();
+
+const BlitKernels& scalar_blit_kernels();
@@ -0,0 +1,90 @@
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+// Fixed-capacity multi-producer single-consumer ring. Unlike MpscQueue it
+// never allocates after construction, so a burst of producers cannot grow
+// it without bound; try_push() fails instead and the producer decides
+// whether to wait, retry or drop. Both sides are lock-free. Only one thread
+// may pop.
+//
+// Each cell carries a sequence number that says whose turn it is: pos when
+// free for the producer that claims position pos, pos + 1 once that value
+// is ready for the consumer.
+template <typename T>
+class BoundedMpscQueue {
+public:
+    // capacity is rounded up to a power of two.
+    explicit BoundedMpscQueue(std::size_t capacity)
+        : mask_(round_up(capacity) - 1), cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+    BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+    // Moves from value only when it returns true; when the queue is full
+    // value is left untouched.
+    bool try_push(T&& value) {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (lag == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                // The consumer has not freed this cell from the last lap.
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // A push that is still in progress may not be visible yet, and holds up
+    // the ones claimed after it; they show up on a later call.
+    std::optional<T> pop() {
+        Cell& cell = cells_[tail_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != tail_ + 1) {
+            return std::nullopt;
+        }
+        std::optional<T> value = std::move(cell.value);
+        cell.value.reset();
+        cell.sequence.store(tail_ + mask_ + 1, std::memory_order_release);
+        ++tail_;
+        return value;
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence{0};
+        std::optional<T> value;
+    };
+
+    static std::size_t round_up(std::size_t capacity) {
+        std::size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::size_t tail_ = 0;
+};
@@ -0,0 +1,176 @@
+
+#include "bulk_render.hpp"
+
+#include "trace.hpp"
+
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace {
+
+// The jobs [begin, end) still owed by one worker, packed into one atomic so
+// the owner taking from the front and thieves taking from the back never
+// both get the same job.
+struct alignas(64) WorkRange {
+    std::atomic<std::uint64_t> packed{0};
+
+    static std::uint64_t pack(std::uint32_t begin, std::uint32_t end) { return static_cast<std::uint64_t>(begin) << 32 | end; }
+    static std::uint32_t begin_of(std::uint64_t value) { return static_cast<std::uint32_t>(value >> 32); }
+    static std::uint32_t end_of(std::uint64_t value) { return static_cast<std::uint32_t>(value); }
+
+    // Claims the first job left.
+    bool take(std::uint32_t& job) {
+        std::uint64_t value = packed.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::uint32_t begin = begin_of(value);
+            const std::uint32_t end = end_of(value);
+            if (begin >= end) {
+                return false;
+            }
+            if (packed.compare_exchange_weak(value, pack(begin + 1, end), std::memory_order_acq_rel)) {
+                job = begin;
+                return true;
+            }
+        }
+    }
+
+    // Claims the back half of the jobs left, leaving the front to the owner.
+    bool steal(std::uint32_t& begin_out, std::uint32_t& end_out) {
+        std::uint64_t value = packed.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::uint32_t begin = begin_of(value);
+            const std::uint32_t end = end_of(value);
+            if (end - begin < 2 || begin >= end) {
+                return false;
+            }
+            const std::uint32_t middle = begin + (end - begin) / 2;
+            if (packed.compare_exchange_weak(value, pack(begin, middle), std::memory_order_acq_rel)) {
+                begin_out = middle;
+                end_out = end;
+                return true;
+            }
+        }
+    }
+
+    std::uint32_t remaining() const {
+        const std::uint64_t value = packed.load(std::memory_order_relaxed);
+        return begin_of(value) < end_of(value) ? end_of(value) - begin_of(value) : 0;
+    }
+};
+
+// The faces one worker has opened, looked up linearly since a batch rarely
+// uses more than a handful of fonts.
+class WorkerFonts {
+public:
+    explicit WorkerFonts(FontManager& fonts)
+        : fonts_(fonts) {}
+
+    TTF_Font* get(const LabelJob& job) {
+        for (const Entry& entry : entries_) {
+            if (entry.size == job.size && entry.style == job.style && entry.path == job.font_path) {
+                return entry.font.get();
+            }
+        }
+        FontHandle font = fonts_.open_exclusive(job.font_path, job.size, job.style);
+        if (!font) {
+            SDL_Log("render_labels: failed to open %s: %s", job.font_path.c_str(), SDL_GetError());
+        }
+        entries_.push_back(Entry{job.font_path, job.size, job.style, std::move(font)});
+        return entries_.back().font.get();
+    }
+
+private:
+    struct Entry {
+        std::string path;
+        float size;
+        TTF_FontStyleFlags style;
+        FontHandle font;
+    };
+
+    FontManager& fonts_;
+    std::vector<Entry> entries_;
+};
+
+SDL_Surface* render_label(WorkerFonts& fonts, const LabelJob& job) {
+    TTF_Font* font = fonts.get(job);
+    if (font == nullptr) {
+        return nullptr;
+    }
+    if (job.wrap_width > 0) {
+        return TTF_RenderText_Blended_Wrapped(font, job.text.data(), job.text.size(), job.color, job.wrap_width);
+    }
+    return TTF_RenderText_Blended(font, job.text.data(), job.text.size(), job.color);
+}
+
+void run_worker(FontManager& fonts, const std::vector<LabelJob>& jobs, std::vector<SDL_Surface*>& surfaces, std::vector<WorkRange>& ranges, std::size_t self) {
+    WorkerFonts worker_fonts(fonts);
+    WorkRange& own = ranges[self];
+    for (;;) {
+        std::uint32_t job = 0;
+        while (own.take(job)) {
+            surfaces[job] = render_label(worker_fonts, jobs[job]);
+        }
+        // Steal from whoever has the most left; only this thread refills
+        // its own range, so storing the stolen span is safe.
+        std::size_t victim = ranges.size();
+        std::uint32_t most = 1;
+        for (std::size_t i = 0; i < ranges.size(); ++i) {
+            if (std::uint32_t left = ranges[i].remaining(); i != self && left > most) {
+                victim = i;
+                most = left;
+            }
+        }
+        std::uint32_t begin = 0;
+        std::uint32_t end = 0;
+        if (victim != ranges.size() && ranges[victim].steal(begin, end)) {
+            own.packed.store(WorkRange::pack(begin, end), std::memory_order_release);
+            continue;
+        }
+        // Single jobs are not stolen; take them directly so none are left
+        // behind once every share is down to its last job.
+        bool found = false;
+        for (std::size_t i = 0; i < ranges.size() && !found; ++i) {
+            if (i != self && ranges[i].take(job)) {
+                surfaces[job] = render_label(worker_fonts, jobs[job]);
+                found = true;
+            }
+        }
+        if (!found) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+std::vector<SDL_Surface*> render_labels(FontManager& fonts, const std::vector<LabelJob>& jobs, BulkRenderConfig config) {
+    TRACE_SCOPE("render_labels");
+    std::vector<SDL_Surface*> surfaces(jobs.size(), nullptr);
+    if (jobs.empty()) {
+        return surfaces;
+    }
+    std::size_t threads = config.threads > 0 ? static_cast<std::size_t>(config.threads) : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, jobs.size());
+    const auto count = static_cast<std::uint32_t>(jobs.size());
+    std::vector<WorkRange> ranges(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        const auto begin = static_cast<std::uint32_t>(count * i / threads);
+        const auto end = static_cast<std::uint32_t>(count * (i + 1) / threads);
+        ranges[i].packed.store(WorkRange::pack(begin, end), std::memory_order_relaxed);
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (std::size_t i = 1; i < threads; ++i) {
+        workers.emplace_back([&, i] { run_worker(fonts, jobs, surfaces, ranges, i); });
+    }
+    run_worker(fonts, jobs, surfaces, ranges, 0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return surfaces;
+}
@@ -0,0 +1,37 @@
+
+#pragma once
+
+#include "font_manager.hpp"
+
+#include <SDL3/SDL_surface.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <string>
+#include <vector>
+
+// One label for render_labels().
+struct LabelJob {
+    std::string text;
+    std::string font_path;
+    float size = 16.0f;
+    TTF_FontStyleFlags style = TTF_STYLE_NORMAL;
+    SDL_Color color{255, 255, 255, 255};
+    // Wraps at this many pixels when non-zero.
+    int wrap_width = 0;
+};
+
+struct BulkRenderConfig {
+    // 0 uses every core.
+    int threads = 0;
+};
+
+// Renders every job with TTF_RenderText_Blended(_Wrapped) across a pool of
+// threads and returns the surfaces in job order; a job that fails leaves a
+// nullptr. The caller destroys the surfaces.
+//
+// TTF_Font is not thread-safe, so each worker opens its own exclusive face
+// of every font it needs from fonts; the font files themselves are mapped
+// once and shared. Jobs start out split evenly between workers, and a worker
+// that runs dry steals half of the largest remaining share, so uneven label
+// lengths do not leave cores idle. The calling thread works too.
+std::vector<SDL_Surface*> render_labels(FontManager& fonts, const std::vector<LabelJob>& jobs, BulkRenderConfig config = {});
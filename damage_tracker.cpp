@@ -0,0 +1,75 @@
+
+#include "damage_tracker.hpp"
+
+#include <cmath>
+
+DamageTracker::DamageTracker(std::size_t max_rects)
+    : max_rects_(max_rects > 0 ? max_rects : 1) {}
+
+void DamageTracker::resize(int w, int h) {
+    w_ = w;
+    h_ = h;
+    add_all();
+}
+
+void DamageTracker::add(const SDL_Rect& rect) {
+    const SDL_Rect target{0, 0, w_, h_};
+    SDL_Rect merged;
+    if (!SDL_GetRectIntersection(&rect, &target, &merged)) {
+        return;
+    }
+    // Absorbing one rectangle can make the union reach another, so keep
+    // merging until nothing overlaps.
+    for (std::size_t i = 0; i < rects_.size();) {
+        if (SDL_HasRectIntersection(&rects_[i], &merged)) {
+            SDL_GetRectUnion(&rects_[i], &merged, &merged);
+            rects_[i] = rects_.back();
+            rects_.pop_back();
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+    rects_.push_back(merged);
+    if (rects_.size() > max_rects_) {
+        const SDL_Rect all = bounds();
+        rects_.assign(1, all);
+    }
+}
+
+void DamageTracker::add(const SDL_FRect& rect) {
+    const auto left = static_cast<int>(std::floor(rect.x));
+    const auto top = static_cast<int>(std::floor(rect.y));
+    const auto right = static_cast<int>(std::ceil(rect.x + rect.w));
+    const auto bottom = static_cast<int>(std::ceil(rect.y + rect.h));
+    add(SDL_Rect{left, top, right - left, bottom - top});
+}
+
+void DamageTracker::add_all() {
+    rects_.clear();
+    if (w_ > 0 && h_ > 0) {
+        rects_.push_back(SDL_Rect{0, 0, w_, h_});
+    }
+}
+
+SDL_Rect DamageTracker::bounds() const {
+    SDL_Rect result{0, 0, 0, 0};
+    for (std::size_t i = 0; i < rects_.size(); ++i) {
+        if (i == 0) {
+            result = rects_[i];
+        } else {
+            SDL_GetRectUnion(&result, &rects_[i], &result);
+        }
+    }
+    return result;
+}
+
+bool DamageTracker::intersects(const SDL_FRect& rect) const {
+    for (const SDL_Rect& damaged : rects_) {
+        if (rect.x < static_cast<float>(damaged.x + damaged.w) && rect.x + rect.w > static_cast<float>(damaged.x) &&
+            rect.y < static_cast<float>(damaged.y + damaged.h) && rect.y + rect.h > static_cast<float>(damaged.y)) {
+            return true;
+        }
+    }
+    return false;
+}
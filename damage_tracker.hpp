@@ -0,0 +1,39 @@
+
+#pragma once
+
+#include <SDL3/SDL_rect.h>
+
+#include <cstddef>
+#include <vector>
+
+// Collects the regions of a render target that changed since the last
+// redraw, so an event-driven loop can skip frames where nothing did and
+// redraw only what is stale when something does. Overlapping rectangles are
+// merged, and past max_rects everything collapses into one bounding box to
+// keep culling against the list cheap.
+class DamageTracker {
+public:
+    explicit DamageTracker(std::size_t max_rects = 16);
+
+    // Sets the target size, clipping future damage to it, and damages the
+    // whole target.
+    void resize(int w, int h);
+
+    void add(const SDL_Rect& rect);
+    void add(const SDL_FRect& rect);
+    void add_all();
+
+    bool empty() const { return rects_.empty(); }
+    const std::vector<SDL_Rect>& rects() const { return rects_; }
+    // Smallest rectangle containing all damage; empty if there is none.
+    SDL_Rect bounds() const;
+    bool intersects(const SDL_FRect& rect) const;
+
+    void clear() { rects_.clear(); }
+
+private:
+    std::size_t max_rects_;
+    int w_ = 0;
+    int h_ = 0;
+    std::vector<SDL_Rect> rects_;
+};
@@ -0,0 +1,144 @@
+
+#include "document_view.hpp"
+
+#include "frame_arena.hpp"
+#include "text_stats.hpp"
+#include "trace.hpp"
+
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+#include <cmath>
+
+DocumentView::DocumentView(TTF_TextEngine* engine, TTF_Font* font, const LineIndex& lines)
+    : DocumentView(engine, font, lines, Config{}) {}
+
+DocumentView::DocumentView(TTF_TextEngine* engine, TTF_Font* font, const LineIndex& lines, Config config)
+    : engine_(engine), font_(font), lines_(lines), config_(config) {}
+
+DocumentView::~DocumentView() {
+    for (TTF_Text* text : window_) {
+        TTF_DestroyText(text);
+    }
+    for (TTF_Text* text : spare_) {
+        TTF_DestroyText(text);
+    }
+}
+
+int DocumentView::line_height() const {
+    return std::max(TTF_GetFontLineSkip(font_), 1);
+}
+
+std::int64_t DocumentView::content_height() const {
+    return static_cast<std::int64_t>(lines_.line_count()) * line_height();
+}
+
+const std::vector<DocumentView::VisibleLine>& DocumentView::layout_visible(double scroll_y, float viewport_h) {
+    TRACE_SCOPE("DocumentView::layout_visible");
+    visible_.clear();
+    const std::size_t count = lines_.line_count();
+    const auto height = static_cast<double>(line_height());
+    scroll_y = std::max(scroll_y, 0.0);
+    const auto first_visible = static_cast<std::size_t>(std::floor(scroll_y / height));
+    const auto end_visible = std::min(count, static_cast<std::size_t>(std::max(0.0, std::ceil((scroll_y + viewport_h) / height))));
+    if (first_visible >= end_visible) {
+        return visible_;
+    }
+    const std::size_t want_first = first_visible - std::min(first_visible, config_.prefetch_lines);
+    const std::size_t want_end = std::min(count, end_visible + config_.prefetch_lines);
+
+    const std::size_t window_end = window_first_ + window_.size();
+    if (window_.empty() || want_end <= window_first_ || want_first >= window_end) {
+        while (!window_.empty()) {
+            release(window_.back());
+            window_.pop_back();
+        }
+        window_first_ = want_first;
+        fill(want_first, want_end - want_first, false);
+    } else {
+        for (; window_first_ < want_first; ++window_first_) {
+            release(window_.front());
+            window_.pop_front();
+        }
+        while (window_first_ + window_.size() > want_end) {
+            release(window_.back());
+            window_.pop_back();
+        }
+        if (want_first < window_first_) {
+            fill(want_first, window_first_ - want_first, true);
+            window_first_ = want_first;
+        }
+        if (const std::size_t end = window_first_ + window_.size(); end < want_end) {
+            fill(end, want_end - end, false);
+        }
+    }
+
+    // How far the first visible line starts above the viewport.
+    const double offset = scroll_y - static_cast<double>(first_visible) * height;
+    for (std::size_t index = first_visible; index < end_visible; ++index) {
+        TTF_Text* text = window_[index - window_first_];
+        if (text != nullptr) {
+            visible_.push_back(VisibleLine{index, text, static_cast<float>(static_cast<double>(index - first_visible) * height - offset)});
+        }
+    }
+    return visible_;
+}
+
+void DocumentView::draw_renderer(float x, float y, double scroll_y, float viewport_h) {
+    for (const VisibleLine& visible : layout_visible(scroll_y, viewport_h)) {
+        TTF_DrawRendererText(visible.text, x, y + visible.y);
+    }
+}
+
+// Lays out count lines from first and adds them to the front or back of the
+// window. Empty lines keep a nullptr slot.
+void DocumentView::fill(std::size_t first, std::size_t count, bool front) {
+    const FrameArena::Scope scratch(frame_arena());
+    ScratchVector<std::string_view> lines = make_scratch_vector<std::string_view>();
+    lines_.lines(first, count, lines);
+    if (front) {
+        for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
+            window_.push_front(make_text(clip_line(*it)));
+        }
+    } else {
+        for (std::string_view line : lines) {
+            window_.push_back(make_text(clip_line(line)));
+        }
+    }
+}
+
+TTF_Text* DocumentView::make_text(std::string_view line) {
+    if (line.empty()) {
+        return nullptr;
+    }
+    TtfTimer timer;
+    if (!spare_.empty()) {
+        TTF_Text* text = spare_.back();
+        spare_.pop_back();
+        TTF_SetTextString(text, line.data(), line.size());
+        return text;
+    }
+    TTF_Text* text = TTF_CreateText(engine_, font_, line.data(), line.size());
+    if (text == nullptr) {
+        SDL_Log("DocumentView: failed to lay out a line: %s", SDL_GetError());
+    }
+    return text;
+}
+
+void DocumentView::release(TTF_Text* text) {
+    if (text != nullptr) {
+        spare_.push_back(text);
+    }
+}
+
+// Cuts line to max_line_bytes without splitting a UTF-8 sequence.
+std::string_view DocumentView::clip_line(std::string_view line) const {
+    if (line.size() <= config_.max_line_bytes) {
+        return line;
+    }
+    std::size_t end = config_.max_line_bytes;
+    while (end > 0 && (static_cast<unsigned char>(line[end]) & 0xC0) == 0x80) {
+        --end;
+    }
+    return line.substr(0, end);
+}
@@ -0,0 +1,82 @@
+
+#pragma once
+
+#include "line_index.hpp"
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <vector>
+
+// A scrolling view of a LineIndex that only ever lays out the lines in the
+// viewport plus prefetch_lines on either side, however large the file.
+//
+// Unlike TextLayout, lines are not wrapped: every line is one line skip
+// tall, so the line at a scroll position is a division away and the
+// content height is known as soon as the lines are counted. Lines longer
+// than max_line_bytes are cut, which keeps a single megabyte-long line from
+// stalling layout.
+//
+// Laid out lines are kept as a window of consecutive TTF_Text objects.
+// Scrolling lays out only the lines that enter the window, and the
+// TTF_Text objects of lines that leave it are reused for them.
+class DocumentView {
+public:
+    struct Config {
+        std::size_t prefetch_lines = 64;
+        std::size_t max_line_bytes = 4096;
+    };
+
+    struct VisibleLine {
+        std::size_t index;
+        TTF_Text* text;
+        // Top of the line relative to the top of the viewport, so it stays
+        // small and exact however far down the document is scrolled.
+        float y;
+    };
+
+    // engine, font and lines must outlive the view.
+    DocumentView(TTF_TextEngine* engine, TTF_Font* font, const LineIndex& lines);
+    DocumentView(TTF_TextEngine* engine, TTF_Font* font, const LineIndex& lines, Config config);
+    ~DocumentView();
+
+    DocumentView(const DocumentView&) = delete;
+    DocumentView& operator=(const DocumentView&) = delete;
+
+    int line_height() const;
+
+    // Height of the lines indexed so far.
+    std::int64_t content_height() const;
+
+    // Lays out what intersects [scroll_y, scroll_y + viewport_h) and the
+    // prefetch margin around it, and returns the visible lines top to
+    // bottom. Valid until the next call. scroll_y is a double since a float
+    // cannot address single pixels past 2^24 px, about a million lines.
+    const std::vector<VisibleLine>& layout_visible(double scroll_y, float viewport_h);
+
+    // Draws the visible lines with TTF_DrawRendererText, with the top of the
+    // viewport at (x, y). engine must be a renderer text engine.
+    void draw_renderer(float x, float y, double scroll_y, float viewport_h);
+
+    // Lines currently holding a TTF_Text.
+    std::size_t live_lines() const { return window_.size(); }
+
+private:
+    void fill(std::size_t first, std::size_t count, bool front);
+    TTF_Text* make_text(std::string_view line);
+    void release(TTF_Text* text);
+    std::string_view clip_line(std::string_view line) const;
+
+    TTF_TextEngine* engine_;
+    TTF_Font* font_;
+    const LineIndex& lines_;
+    Config config_;
+    // TTF_Texts for lines window_first_ .. window_first_ + window_.size().
+    std::deque<TTF_Text*> window_;
+    std::size_t window_first_ = 0;
+    std::vector<TTF_Text*> spare_;
+    std::vector<VisibleLine> visible_;
+};
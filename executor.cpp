@@ -0,0 +1,111 @@
+
+#include "executor.hpp"
+
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_timer.h>
+
+#include <exception>
+
+namespace {
+
+// Owns a spawned task. It starts eagerly and frees itself when done.
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+template <typename Done>
+Detached run_detached(Task<void> task, Done done) {
+    {
+        // Scoped so the task's frame, and everything it captured, is gone
+        // before the executor hears it has finished.
+        Task<void> owned = std::move(task);
+        co_await std::move(owned);
+    }
+    done();
+}
+
+} // namespace
+
+Executor::Executor()
+    : Executor(Config{}) {}
+
+Executor::Executor(Config config)
+    : config_(config), render_thread_(std::this_thread::get_id()) {
+    const int threads = config_.threads > 0 ? config_.threads : 1;
+    for (int i = 0; i < threads; ++i) {
+        workers_.emplace_back([this] { run_worker(); });
+    }
+}
+
+Executor::~Executor() {
+    while (in_flight() > 0) {
+        if (run_pending() == 0) {
+            SDL_Delay(1);
+        }
+    }
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void Executor::spawn(Task<void> task) {
+    in_flight_.fetch_add(1, std::memory_order_acq_rel);
+    run_detached(std::move(task), [this] { finish_task(); });
+}
+
+std::size_t Executor::run_pending() {
+    std::size_t resumed = 0;
+    while (auto handle = render_jobs_.pop()) {
+        handle->resume();
+        ++resumed;
+    }
+    return resumed;
+}
+
+void Executor::post_worker(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard lock(mutex_);
+        worker_jobs_.push_back(handle);
+    }
+    wake_.notify_one();
+}
+
+void Executor::post_render(std::coroutine_handle<> handle) {
+    render_jobs_.push(handle);
+    if (config_.wake_event != 0) {
+        SDL_Event event{};
+        event.type = config_.wake_event;
+        SDL_PushEvent(&event);
+    }
+}
+
+void Executor::run_worker() {
+    for (;;) {
+        std::coroutine_handle<> handle;
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !worker_jobs_.empty(); });
+            if (worker_jobs_.empty()) {
+                return;
+            }
+            handle = worker_jobs_.front();
+            worker_jobs_.pop_front();
+        }
+        handle.resume();
+    }
+}
+
+void Executor::finish_task() {
+    in_flight_.fetch_sub(1, std::memory_order_acq_rel);
+}
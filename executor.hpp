@@ -0,0 +1,95 @@
+
+#pragma once
+
+#include "mpsc_queue.hpp"
+#include "task.hpp"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs Tasks across a small worker pool and the render thread, the thread
+// that created the executor. A task moves itself between them:
+//
+//     co_await executor.on_worker();   // open files, rasterize
+//     co_await executor.on_render();   // create textures, touch the atlas
+//
+// Render-thread steps run from run_pending(), which the event loop calls
+// once per iteration. With a wake_event set, every step handed to the
+// render thread also pushes that SDL event, so a loop blocked in
+// SDL_WaitEvent wakes up to run it.
+//
+// Destruction waits for every spawned task to finish, running their
+// render-thread steps itself, so tasks may refer to objects that outlive
+// the executor.
+class Executor {
+public:
+    struct Config {
+        int threads = 2;
+        Uint32 wake_event = 0;
+    };
+
+    Executor();
+    explicit Executor(Config config);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // Starts task on the calling thread; it runs until its first co_await
+    // that switches threads.
+    void spawn(Task<void> task);
+
+    // Render thread only. Resumes every step handed to the render thread so
+    // far and returns how many there were.
+    std::size_t run_pending();
+
+    // Tasks spawned and not yet finished.
+    std::size_t in_flight() const { return in_flight_.load(std::memory_order_acquire); }
+
+    auto on_worker() {
+        struct Awaiter {
+            Executor& executor;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor.post_worker(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    // Completes immediately when already on the render thread.
+    auto on_render() {
+        struct Awaiter {
+            Executor& executor;
+
+            bool await_ready() const noexcept { return std::this_thread::get_id() == executor.render_thread_; }
+            void await_suspend(std::coroutine_handle<> handle) { executor.post_render(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+private:
+    void post_worker(std::coroutine_handle<> handle);
+    void post_render(std::coroutine_handle<> handle);
+    void run_worker();
+    void finish_task();
+
+    Config config_;
+    std::thread::id render_thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::coroutine_handle<>> worker_jobs_;
+    bool stopping_ = false;
+    MpscQueue<std::coroutine_handle<>> render_jobs_;
+    std::atomic<std::size_t> in_flight_{0};
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,88 @@
+
+#include "font_fallback.hpp"
+
+#include "trace.hpp"
+
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+
+FontFallback::FontFallback(std::vector<FontHandle> fonts)
+    : fonts_(std::move(fonts)), table_(page_count, nullptr) {
+    if (fonts_.size() >= none) {
+        SDL_Log("FontFallback: %zu fonts given, only the first %d are used", fonts_.size(), none - 1);
+        fonts_.resize(none - 1);
+    }
+    uniform_.resize(fonts_.size() + 1);
+}
+
+void FontFallback::preload(Uint32 first, Uint32 last) {
+    last = std::min<Uint32>(last, 0x10FFFF);
+    if (first > last) {
+        return;
+    }
+    for (Uint32 page = first >> 8; page <= last >> 8; ++page) {
+        if (table_[page] == nullptr) {
+            resolve(page);
+        }
+    }
+}
+
+std::size_t FontFallback::memory_used() const {
+    const std::size_t pages = mixed_.size() + std::count_if(uniform_.begin(), uniform_.end(), [](const auto& page) { return page != nullptr; });
+    return table_.size() * sizeof(const Page*) + pages * sizeof(Page);
+}
+
+void FontFallback::set_memory_limit(std::size_t bytes) {
+    const std::size_t fixed = table_.size() * sizeof(const Page*) + uniform_.size() * sizeof(Page);
+    max_mixed_ = bytes > fixed ? (bytes - fixed) / sizeof(Page) : 0;
+    if (mixed_.size() > max_mixed_) {
+        drop_mixed();
+    }
+}
+
+void FontFallback::drop_mixed() {
+    for (const Page*& entry : table_) {
+        if (entry != nullptr && std::none_of(uniform_.begin(), uniform_.end(), [entry](const auto& page) { return page.get() == entry; })) {
+            entry = nullptr;
+            --resolved_;
+        }
+    }
+    mixed_.clear();
+}
+
+const FontFallback::Page& FontFallback::resolve(Uint32 page) {
+    TRACE_SCOPE("FontFallback::resolve");
+    Page indices;
+    indices.fill(none);
+    // Font by font rather than codepoint by codepoint so each face's charmap
+    // stays hot while it is probed.
+    for (std::size_t font = 0; font < fonts_.size(); ++font) {
+        TTF_Font* face = fonts_[font].get();
+        if (face == nullptr) {
+            continue;
+        }
+        for (Uint32 low = 0; low < 256; ++low) {
+            if (indices[low] == none && TTF_FontHasGlyph(face, page << 8 | low)) {
+                indices[low] = static_cast<Uint8>(font);
+            }
+        }
+    }
+    ++resolved_;
+    const Page* resolved = nullptr;
+    if (std::all_of(indices.begin(), indices.end(), [&](Uint8 index) { return index == indices[0]; })) {
+        std::unique_ptr<Page>& uniform = uniform_[indices[0] == none ? fonts_.size() : indices[0]];
+        if (uniform == nullptr) {
+            uniform = std::make_unique<Page>(indices);
+        }
+        resolved = uniform.get();
+    } else {
+        if (mixed_.size() >= max_mixed_) {
+            drop_mixed();
+        }
+        mixed_.push_back(std::make_unique<Page>(indices));
+        resolved = mixed_.back().get();
+    }
+    table_[page] = resolved;
+    return *resolved;
+}
@@ -0,0 +1,139 @@
+
+#pragma once
+
+#include "font_manager.hpp"
+#include "utf8.hpp"
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// An ordered list of fonts, each codepoint drawn with the first one that has
+// a glyph for it, e.g. a Latin UI font followed by CJK and emoji fonts.
+//
+// Which font covers a codepoint is kept in a two-level table of 256-entry
+// pages indexed by codepoint >> 8, so after a page has been resolved every
+// lookup in it is two loads instead of a TTF_FontHasGlyph() per font. A page
+// is resolved by probing the whole chain once, the first time any of its
+// codepoints is asked for; pages that resolve to one font throughout, which
+// is most of them, share a single page per font.
+//
+// Handles switch their face's size in get(), so use the chain on the render
+// thread like the handles themselves.
+class FontFallback {
+public:
+    // Returned by font_index() for codepoints no font in the chain has.
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // At most 255 fonts.
+    explicit FontFallback(std::vector<FontHandle> fonts);
+
+    FontFallback(const FontFallback&) = delete;
+    FontFallback& operator=(const FontFallback&) = delete;
+
+    // Index in the chain of the font that draws cp, or npos.
+    std::size_t font_index(Uint32 cp);
+
+    // The font that draws cp. Codepoints nobody has map to the first font,
+    // so they come out as its missing-glyph box rather than disappearing.
+    TTF_Font* font_for(Uint32 cp);
+
+    // Resolves the pages covering [first, last] ahead of time, e.g. at load
+    // time for the scripts a screen is known to use.
+    void preload(Uint32 first, Uint32 last);
+
+    // Splits UTF-8 text into runs that each use one font and calls
+    // fn(TTF_Font*, std::string_view run) for each, in order.
+    template <typename Fn>
+    void for_each_run(std::string_view text, Fn&& fn);
+
+    // Queues text into batch (TextBatch or GpuTextRenderer) one run at a
+    // time with the runs' baselines lined up with the first font's. Returns
+    // the x coordinate just past the text.
+    template <typename Batch>
+    float add(Batch& batch, std::string_view text, float x, float y, SDL_FColor color);
+
+    std::size_t size() const { return fonts_.size(); }
+    std::size_t resolved_pages() const { return resolved_; }
+
+    // The table itself is fixed; pages mixing several fonts are added as
+    // they are resolved. Once those exceed the limit they are all dropped
+    // and resolved again on demand.
+    std::size_t memory_used() const;
+    void set_memory_limit(std::size_t bytes);
+
+private:
+    using Page = std::array<Uint8, 256>;
+
+    static constexpr Uint8 none = 0xFF;
+    static constexpr Uint32 page_count = 0x110000 >> 8;
+
+    const Page& resolve(Uint32 page);
+    void drop_mixed();
+
+    std::vector<FontHandle> fonts_;
+    // page_count entries, nullptr until resolved.
+    std::vector<const Page*> table_;
+    // uniform_[i] is the page for blocks entirely drawn by font i; the last
+    // entry is the page for blocks no font covers.
+    std::vector<std::unique_ptr<Page>> uniform_;
+    std::vector<std::unique_ptr<Page>> mixed_;
+    std::size_t resolved_ = 0;
+    std::size_t max_mixed_ = static_cast<std::size_t>(-1);
+};
+
+inline std::size_t FontFallback::font_index(Uint32 cp) {
+    if (cp >= 0x110000) {
+        return npos;
+    }
+    const Page* page = table_[cp >> 8];
+    const Uint8 index = (page != nullptr ? *page : resolve(cp >> 8))[cp & 0xFF];
+    return index == none ? npos : index;
+}
+
+inline TTF_Font* FontFallback::font_for(Uint32 cp) {
+    const std::size_t index = font_index(cp);
+    return fonts_.empty() ? nullptr : fonts_[index == npos ? 0 : index].get();
+}
+
+template <typename Fn>
+void FontFallback::for_each_run(std::string_view text, Fn&& fn) {
+    if (fonts_.empty()) {
+        return;
+    }
+    std::size_t start = 0;
+    std::size_t current = npos;
+    for (std::size_t pos = 0; pos < text.size();) {
+        const std::size_t at = pos;
+        std::size_t index = font_index(utf8_next(text, pos));
+        if (index == npos) {
+            index = current == npos ? 0 : current;
+        }
+        if (index != current) {
+            if (current != npos) {
+                fn(fonts_[current].get(), text.substr(start, at - start));
+            }
+            start = at;
+            current = index;
+        }
+    }
+    if (current != npos) {
+        fn(fonts_[current].get(), text.substr(start));
+    }
+}
+
+template <typename Batch>
+float FontFallback::add(Batch& batch, std::string_view text, float x, float y, SDL_FColor color) {
+    if (fonts_.empty()) {
+        return x;
+    }
+    const int ascent = TTF_GetFontAscent(fonts_.front().get());
+    for_each_run(text, [&](TTF_Font* font, std::string_view run) {
+        x = batch.add(font, run, x, y + static_cast<float>(ascent - TTF_GetFontAscent(font)), color);
+    });
+    return x;
+}
@@ -0,0 +1,100 @@
+
+#include "font_loader.hpp"
+
+#include "trace.hpp"
+
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_log.h>
+
+#include <utility>
+
+FontLoader::FontLoader(FontManager& fonts)
+    : FontLoader(fonts, Config{}) {}
+
+FontLoader::FontLoader(FontManager& fonts, Config config)
+    : fonts_(fonts), config_(config) {
+    const int threads = config_.threads > 0 ? config_.threads : 1;
+    for (int i = 0; i < threads; ++i) {
+        workers_.emplace_back([this] { run(); });
+    }
+}
+
+FontLoader::~FontLoader() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    while (auto loaded = done_.pop()) {
+        destroy_atlas_pages(loaded->pages);
+    }
+}
+
+Uint64 FontLoader::request(std::string path, float size, std::vector<CodepointRange> prewarm) {
+    Uint64 id = 0;
+    {
+        std::lock_guard lock(mutex_);
+        id = next_id_++;
+        jobs_.push_back(Job{id, std::move(path), size, std::move(prewarm)});
+    }
+    wake_.notify_one();
+    return id;
+}
+
+std::optional<LoadedFont> FontLoader::poll() {
+    return done_.pop();
+}
+
+void FontLoader::run() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        done_.push(load(job));
+        if (config_.wake_event != 0) {
+            SDL_Event event{};
+            event.type = config_.wake_event;
+            SDL_PushEvent(&event);
+        }
+    }
+}
+
+LoadedFont FontLoader::load(Job& job) const {
+    LoadedFont loaded;
+    loaded.id = job.id;
+    loaded.path = std::move(job.path);
+    loaded.size = job.size;
+    loaded.font = fonts_.open_exclusive(loaded.path, job.size);
+    if (!loaded.font) {
+        loaded.error = SDL_GetError();
+        return loaded;
+    }
+    if (!job.prewarm.empty()) {
+        TRACE_SCOPE("build_atlas_pages");
+        loaded.pages = build_atlas_pages(loaded.font.get(), job.prewarm, config_.page_size, config_.padding);
+    }
+    return loaded;
+}
+
+FontHandle adopt_loaded_font(GlyphAtlas& atlas, LoadedFont& loaded) {
+    if (!loaded.font) {
+        SDL_Log("FontLoader: failed to open %s: %s", loaded.path.c_str(), loaded.error.c_str());
+        return FontHandle();
+    }
+    for (const AtlasPageImage& page : loaded.pages) {
+        atlas.adopt_page(loaded.font.get(), page);
+    }
+    destroy_atlas_pages(loaded.pages);
+    return std::move(loaded.font);
+}
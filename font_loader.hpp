@@ -0,0 +1,86 @@
+
+#pragma once
+
+#include "atlas_page_builder.hpp"
+#include "font_manager.hpp"
+#include "glyph_atlas.hpp"
+#include "mpsc_queue.hpp"
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A font opened by a FontLoader worker. The page surfaces belong to
+// whoever pops the result. font is empty and error is set when the open
+// failed.
+struct LoadedFont {
+    Uint64 id = 0;
+    std::string path;
+    float size = 0.0f;
+    FontHandle font;
+    std::vector<AtlasPageImage> pages;
+    std::string error;
+};
+
+// Opens fonts and pre-rasterizes glyph ranges on worker threads so large
+// (e.g. CJK) faces do not stall the render thread. Finished fonts come back
+// through a lock-free queue drained with poll(). Each load gets an
+// exclusive face from the FontManager passed in, since the worker renders
+// with it while the render thread may be using the shared faces.
+class FontLoader {
+public:
+    struct Config {
+        int threads = 2;
+        // Must match the GlyphAtlas the pages are adopted into.
+        int page_size = 1024;
+        int padding = 1;
+        // When non-zero, an SDL event of this type (see SDL_RegisterEvents)
+        // is pushed as each load finishes, so a loop blocked in SDL_WaitEvent
+        // wakes up to poll().
+        Uint32 wake_event = 0;
+    };
+
+    explicit FontLoader(FontManager& fonts);
+    FontLoader(FontManager& fonts, Config config);
+    ~FontLoader();
+
+    FontLoader(const FontLoader&) = delete;
+    FontLoader& operator=(const FontLoader&) = delete;
+
+    // Queues a load and returns the id its LoadedFont will carry.
+    Uint64 request(std::string path, float size, std::vector<CodepointRange> prewarm = {});
+
+    // Render thread only. Returns the next finished load, if any.
+    std::optional<LoadedFont> poll();
+
+private:
+    struct Job {
+        Uint64 id;
+        std::string path;
+        float size;
+        std::vector<CodepointRange> prewarm;
+    };
+
+    void run();
+    LoadedFont load(Job& job) const;
+
+    FontManager& fonts_;
+    Config config_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Job> jobs_;
+    bool stopping_ = false;
+    Uint64 next_id_ = 1;
+    MpscQueue<LoadedFont> done_;
+    std::vector<std::thread> workers_;
+};
+
+// Uploads the pages of a successful load into atlas and releases their
+// surfaces. Returns the loaded font, or an empty handle if the load failed.
+FontHandle adopt_loaded_font(GlyphAtlas& atlas, LoadedFont& loaded);
@@ -0,0 +1,235 @@
+
+#include "font_manager.hpp"
+
+#include "trace.hpp"
+
+#include <SDL3/SDL_iostream.h>
+
+#include <functional>
+#include <utility>
+
+namespace {
+
+// SDL3_ttf shares one FreeType library between fonts, and FreeType does not
+// allow faces to be created or destroyed on it concurrently.
+std::mutex& face_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+} // namespace
+
+struct FontCloseListeners {
+    std::mutex mutex;
+    int next_id = 1;
+    std::vector<std::pair<int, std::function<void(TTF_Font*)>>> listeners;
+
+    void notify(TTF_Font* font) {
+        // Copied so a listener may be removed while the others run.
+        std::vector<std::pair<int, std::function<void(TTF_Font*)>>> current;
+        {
+            std::lock_guard lock(mutex);
+            current = listeners;
+        }
+        for (const auto& [id, fn] : current) {
+            fn(font);
+        }
+    }
+
+    void remove(int id) {
+        std::lock_guard lock(mutex);
+        std::erase_if(listeners, [id](const auto& listener) { return listener.first == id; });
+    }
+};
+
+struct FontFace {
+    TTF_Font* font;
+    // Keeps the mapping alive for as long as the font reads from it.
+    std::shared_ptr<MappedFile> mapped;
+    float current_size;
+    std::shared_ptr<FontCloseListeners> listeners;
+
+    ~FontFace() { close(); }
+
+    void close() {
+        if (font != nullptr) {
+            listeners->notify(font);
+            std::lock_guard lock(face_mutex());
+            TTF_CloseFont(font);
+            font = nullptr;
+        }
+    }
+};
+
+struct FontVariant {
+    std::shared_ptr<FontFace> face;
+    float size;
+};
+
+TTF_Font* FontHandle::get() const {
+    if (variant_ == nullptr) {
+        return nullptr;
+    }
+    FontFace& face = *variant_->face;
+    if (face.font != nullptr && face.current_size != variant_->size) {
+        TTF_SetFontSize(face.font, variant_->size);
+        face.current_size = variant_->size;
+    }
+    return face.font;
+}
+
+float FontHandle::size() const {
+    return variant_ != nullptr ? variant_->size : 0.0f;
+}
+
+std::size_t FontManager::FaceKeyHash::operator()(const FaceKey& key) const noexcept {
+    std::size_t h = std::hash<std::string>{}(key.path);
+    h ^= std::hash<Uint32>{}(key.style) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= std::hash<bool>{}(key.sdf) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+std::size_t FontManager::VariantKeyHash::operator()(const VariantKey& key) const noexcept {
+    std::size_t h = std::hash<std::string>{}(key.path);
+    h ^= std::hash<float>{}(key.size) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= std::hash<Uint32>{}(key.style) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= std::hash<bool>{}(key.sdf) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+FontManager::CloseListener::~CloseListener() {
+    if (listeners_ != nullptr) {
+        listeners_->remove(id_);
+    }
+}
+
+FontManager::CloseListener::CloseListener(CloseListener&& other) noexcept
+    : listeners_(std::move(other.listeners_)), id_(other.id_) {}
+
+FontManager::CloseListener& FontManager::CloseListener::operator=(CloseListener&& other) noexcept {
+    if (this != &other) {
+        if (listeners_ != nullptr) {
+            listeners_->remove(id_);
+        }
+        listeners_ = std::move(other.listeners_);
+        id_ = other.id_;
+    }
+    return *this;
+}
+
+FontManager::FontManager()
+    : listeners_(std::make_shared<FontCloseListeners>()) {}
+
+FontManager::~FontManager() {
+    close_all();
+}
+
+FontManager::CloseListener FontManager::on_close(std::function<void(TTF_Font*)> fn) {
+    std::lock_guard lock(listeners_->mutex);
+    const int id = listeners_->next_id++;
+    listeners_->listeners.emplace_back(id, std::move(fn));
+    return CloseListener(listeners_, id);
+}
+
+FontHandle FontManager::open(const std::string& path, float size, TTF_FontStyleFlags style) {
+    TRACE_SCOPE("FontManager::open");
+    return open_shared(path, size, style, false);
+}
+
+FontHandle FontManager::open_sdf(const std::string& path, float reference_size, TTF_FontStyleFlags style) {
+    TRACE_SCOPE("FontManager::open_sdf");
+    return open_shared(path, reference_size, style, true);
+}
+
+FontHandle FontManager::open_shared(const std::string& path, float size, TTF_FontStyleFlags style, bool sdf) {
+    std::lock_guard lock(mutex_);
+    auto& cached_variant = variants_[VariantKey{path, size, style, sdf}];
+    if (auto variant = cached_variant.lock()) {
+        return FontHandle(std::move(variant));
+    }
+    auto& cached_face = faces_[FaceKey{path, style, sdf}];
+    std::shared_ptr<FontFace> face = cached_face.lock();
+    if (face == nullptr || face->font == nullptr) {
+        face = open_face(path, size, style, sdf);
+        if (face == nullptr) {
+            return FontHandle();
+        }
+        cached_face = face;
+    }
+    auto variant = std::make_shared<FontVariant>(FontVariant{std::move(face), size});
+    cached_variant = variant;
+    return FontHandle(std::move(variant));
+}
+
+FontHandle FontManager::open_exclusive(const std::string& path, float size, TTF_FontStyleFlags style) {
+    TRACE_SCOPE("FontManager::open_exclusive");
+    std::lock_guard lock(mutex_);
+    std::shared_ptr<FontFace> face = open_face(path, size, style, false);
+    if (face == nullptr) {
+        return FontHandle();
+    }
+    return FontHandle(std::make_shared<FontVariant>(FontVariant{std::move(face), size}));
+}
+
+void FontManager::close_all() {
+    std::lock_guard lock(mutex_);
+    for (const auto& weak : all_faces_) {
+        if (auto face = weak.lock()) {
+            face->close();
+        }
+    }
+    all_faces_.clear();
+    faces_.clear();
+    variants_.clear();
+    mappings_.clear();
+}
+
+std::size_t FontManager::face_count() {
+    std::lock_guard lock(mutex_);
+    std::size_t count = 0;
+    for (const auto& weak : all_faces_) {
+        if (auto face = weak.lock(); face != nullptr && face->font != nullptr) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::shared_ptr<FontFace> FontManager::open_face(const std::string& path, float size, TTF_FontStyleFlags style, bool sdf) {
+    std::shared_ptr<MappedFile> mapped = map(path);
+    TTF_Font* font = nullptr;
+    {
+        std::lock_guard lock(face_mutex());
+        if (mapped != nullptr) {
+            SDL_IOStream* io = SDL_IOFromConstMem(mapped->data(), mapped->size());
+            font = io != nullptr ? TTF_OpenFontIO(io, true, size) : nullptr;
+        } else {
+            font = TTF_OpenFont(path.c_str(), size);
+        }
+    }
+    if (font == nullptr) {
+        return nullptr;
+    }
+    if (style != TTF_STYLE_NORMAL) {
+        TTF_SetFontStyle(font, style);
+    }
+    if (sdf && !TTF_SetFontSDF(font, true)) {
+        std::lock_guard lock(face_mutex());
+        TTF_CloseFont(font);
+        return nullptr;
+    }
+    auto face = std::make_shared<FontFace>(FontFace{font, std::move(mapped), size, listeners_});
+    std::erase_if(all_faces_, [](const std::weak_ptr<FontFace>& weak) { return weak.expired(); });
+    all_faces_.push_back(face);
+    return face;
+}
+
+std::shared_ptr<MappedFile> FontManager::map(const std::string& path) {
+    auto& cached = mappings_[path];
+    std::shared_ptr<MappedFile> mapped = cached.lock();
+    if (mapped == nullptr) {
+        mapped = MappedFile::open(path);
+        cached = mapped;
+    }
+    return mapped;
+}
@@ -0,0 +1,159 @@
+
+#pragma once
+
+#include "mapped_file.hpp"
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FontFace;
+struct FontVariant;
+struct FontCloseListeners;
+
+// A reference-counted (face, size) pair handed out by FontManager. Copies
+// are cheap and share the same TTF_Font. Several handles of different
+// sizes may share one face, so get() switches the face to this handle's
+// size before returning it; use the font straight away and on the render
+// thread, except for handles from FontManager::open_exclusive().
+class FontHandle {
+public:
+    FontHandle() = default;
+
+    // Returns nullptr for an empty handle or once the manager has closed
+    // everything.
+    TTF_Font* get() const;
+    float size() const;
+
+    explicit operator bool() const { return variant_ != nullptr; }
+    bool operator==(const FontHandle& other) const { return variant_ == other.variant_; }
+
+private:
+    friend class FontManager;
+
+    explicit FontHandle(std::shared_ptr<FontVariant> variant)
+        : variant_(std::move(variant)) {}
+
+    std::shared_ptr<FontVariant> variant_;
+};
+
+// Owns every TTF_Font the app opens.
+//
+// Opens are deduplicated by (path, size, style): asking again for the same
+// combination returns another handle to the same font. Different sizes of
+// the same (path, style) share one face and TTF_SetFontSize switches
+// between them, so the font tables are parsed once per face. A face is
+// closed when its last handle goes away.
+//
+// Font files are memory-mapped once per path and handed to TTF_OpenFontIO
+// through a read-only SDL_IOStream, so the file is never copied and its
+// pages are shared between processes. Files that cannot be mapped are opened
+// with TTF_OpenFont instead.
+//
+// open() may be called from any thread. Create after TTF_Init() and destroy
+// before TTF_Quit(); destruction closes every face, leaving any handle still
+// alive empty.
+//
+// Since a shared face closes whenever its last handle happens to go away,
+// caches keyed by TTF_Font* (GlyphAtlas, ShapedRunCache, TextMeasureCache)
+// register with on_close() to forget a font before a new one can be opened
+// at the same address.
+class FontManager {
+public:
+    // Keeps a callback registered with on_close() until destroyed.
+    class CloseListener {
+    public:
+        CloseListener() = default;
+        ~CloseListener();
+
+        CloseListener(CloseListener&& other) noexcept;
+        CloseListener& operator=(CloseListener&& other) noexcept;
+
+    private:
+        friend class FontManager;
+
+        CloseListener(std::shared_ptr<FontCloseListeners> listeners, int id)
+            : listeners_(std::move(listeners)), id_(id) {}
+
+        std::shared_ptr<FontCloseListeners> listeners_;
+        int id_ = 0;
+    };
+
+    FontManager();
+    ~FontManager();
+
+    FontManager(const FontManager&) = delete;
+    FontManager& operator=(const FontManager&) = delete;
+
+    // Returns an empty handle with the SDL error set on failure.
+    FontHandle open(const std::string& path, float size, TTF_FontStyleFlags style = TTF_STYLE_NORMAL);
+
+    // Opens a face of its own that no other open() will share, so the handle
+    // may be used on another thread while the render thread keeps drawing
+    // with the shared faces.
+    FontHandle open_exclusive(const std::string& path, float size, TTF_FontStyleFlags style = TTF_STYLE_NORMAL);
+
+    // Opens a face that renders signed distance fields (TTF_SetFontSDF) at
+    // reference_size. Glyphs from it are rasterized once and drawn at any
+    // size by scaling, see TextBatch::add_scaled() and
+    // SurfaceTextRenderer::draw_scaled(). SDF faces are never shared with
+    // open(), whose glyphs would otherwise come out as fields.
+    FontHandle open_sdf(const std::string& path, float reference_size, TTF_FontStyleFlags style = TTF_STYLE_NORMAL);
+
+    void close_all();
+
+    // Calls fn with each face's TTF_Font just before it is closed, either
+    // because its last handle went away or by close_all(). fn runs on the
+    // thread that closes the face, so a render-thread cache should only be
+    // registered for fonts whose handles are dropped there, and it must not
+    // call back into the manager.
+    [[nodiscard]] CloseListener on_close(std::function<void(TTF_Font*)> fn);
+
+    std::size_t face_count();
+
+private:
+    struct FaceKey {
+        std::string path;
+        TTF_FontStyleFlags style;
+        bool sdf;
+
+        bool operator==(const FaceKey&) const = default;
+    };
+
+    struct VariantKey {
+        std::string path;
+        float size;
+        TTF_FontStyleFlags style;
+        bool sdf;
+
+        bool operator==(const VariantKey&) const = default;
+    };
+
+    struct FaceKeyHash {
+        std::size_t operator()(const FaceKey& key) const noexcept;
+    };
+
+    struct VariantKeyHash {
+        std::size_t operator()(const VariantKey& key) const noexcept;
+    };
+
+    FontHandle open_shared(const std::string& path, float size, TTF_FontStyleFlags style, bool sdf);
+    std::shared_ptr<FontFace> open_face(const std::string& path, float size, TTF_FontStyleFlags style, bool sdf);
+    std::shared_ptr<MappedFile> map(const std::string& path);
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::weak_ptr<MappedFile>> mappings_;
+    std::unordered_map<FaceKey, std::weak_ptr<FontFace>, FaceKeyHash> faces_;
+    std::unordered_map<VariantKey, std::weak_ptr<FontVariant>, VariantKeyHash> variants_;
+    // Every face ever opened, including exclusive ones, so close_all() can
+    // reach faces whose handles are still alive.
+    std::vector<std::weak_ptr<FontFace>> all_faces_;
+    // Shared with every face, whose close() notifies them.
+    std::shared_ptr<FontCloseListeners> listeners_;
+};
@@ -0,0 +1,61 @@
+
+#include "frame_arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+std::size_t align_up(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+FrameArena::FrameArena(std::size_t chunk_size)
+    : chunk_size_(chunk_size) {}
+
+void* FrameArena::allocate(std::size_t size, std::size_t alignment) {
+    while (current_ < chunks_.size()) {
+        Chunk& chunk = chunks_[current_];
+        const auto base = reinterpret_cast<std::uintptr_t>(chunk.memory.get());
+        const std::size_t start = align_up(base + offset_, alignment) - base;
+        if (start + size <= chunk.size) {
+            offset_ = start + size;
+            return chunk.memory.get() + start;
+        }
+        used_before_current_ += offset_;
+        ++current_;
+        offset_ = 0;
+    }
+    // Oversized requests get a chunk of their own so one big frame does not
+    // leave every later chunk oversized too.
+    const std::size_t size_needed = size + alignment;
+    const std::size_t chunk_size = std::max(chunk_size_, size_needed);
+    chunks_.push_back(Chunk{std::make_unique<std::byte[]>(chunk_size), chunk_size});
+    current_ = chunks_.size() - 1;
+    return allocate(size, alignment);
+}
+
+void FrameArena::reset() {
+    current_ = 0;
+    offset_ = 0;
+    used_before_current_ = 0;
+}
+
+std::size_t FrameArena::bytes_used() const {
+    return used_before_current_ + offset_;
+}
+
+std::size_t FrameArena::bytes_reserved() const {
+    std::size_t total = 0;
+    for (const Chunk& chunk : chunks_) {
+        total += chunk.size;
+    }
+    return total;
+}
+
+FrameArena& frame_arena() {
+    thread_local FrameArena arena;
+    return arena;
+}
@@ -0,0 +1,107 @@
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for scratch memory that only lives while a layout step
+// runs: line breaks, wrap points, glyph position arrays. Allocation is a
+// pointer increment, individual frees are no-ops, and a Scope or reset()
+// makes the memory reusable at once. Chunks are kept, so after the first
+// few uses the arena stops touching the heap.
+class FrameArena {
+public:
+    // Rewinds the arena on destruction to where it was on construction,
+    // freeing everything allocated in between. Scopes nest, and they work
+    // on any thread without anyone having to call reset().
+    class Scope {
+    public:
+        explicit Scope(FrameArena& arena) noexcept
+            : arena_(arena), current_(arena.current_), offset_(arena.offset_), used_before_current_(arena.used_before_current_) {}
+
+        ~Scope() {
+            arena_.current_ = current_;
+            arena_.offset_ = offset_;
+            arena_.used_before_current_ = used_before_current_;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameArena& arena_;
+        std::size_t current_;
+        std::size_t offset_;
+        std::size_t used_before_current_;
+    };
+
+    explicit FrameArena(std::size_t chunk_size = 64 * 1024);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    // Invalidates everything allocated since the last reset.
+    void reset();
+
+    std::size_t bytes_used() const;
+    std::size_t bytes_reserved() const;
+
+private:
+    struct Chunk {
+        std::unique_ptr<std::byte[]> memory;
+        std::size_t size;
+    };
+
+    std::size_t chunk_size_;
+    std::vector<Chunk> chunks_;
+    std::size_t current_ = 0;
+    std::size_t offset_ = 0;
+    std::size_t used_before_current_ = 0;
+};
+
+// The calling thread's frame arena. Nothing resets it, so every use sits
+// inside a FrameArena::Scope and must not keep what it took past the end
+// of that scope.
+FrameArena& frame_arena();
+
+// Standard allocator over a FrameArena, for scratch containers such as
+// std::vector<T, ArenaAllocator<T>>.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(FrameArena& arena) noexcept
+        : arena_(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(other.arena()) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) noexcept {}
+
+    FrameArena* arena() const noexcept { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena_ == other.arena(); }
+
+private:
+    FrameArena* arena_;
+};
+
+template <typename T>
+using ScratchVector = std::vector<T, ArenaAllocator<T>>;
+
+// An empty vector drawing from the calling thread's frame arena. Declare it
+// after the Scope it belongs to.
+template <typename T>
+ScratchVector<T> make_scratch_vector() {
+    return ScratchVector<T>(ArenaAllocator<T>(frame_arena()));
+}
@@ -0,0 +1,582 @@
+
+#include "glyph_atlas.hpp"
+
+#include "glyph_raster.hpp"
+#include "glyph_upload_queue.hpp"
+#include "text_stats.hpp"
+#include "trace.hpp"
+
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_timer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <tuple>
+
+GlyphKey GlyphKey::of(TTF_Font* font, Uint32 codepoint, GlyphRenderMode mode) {
+    return GlyphKey{font, TTF_GetFontSize(font), codepoint, TTF_GetFontHinting(font), TTF_GetFontSDF(font), mode};
+}
+
+std::size_t GlyphKeyHash::operator()(const GlyphKey& key) const noexcept {
+    std::size_t h = std::hash<const void*>{}(key.font);
+    h ^= std::hash<float>{}(key.size) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= std::hash<Uint32>{}(key.codepoint) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    const auto variant = static_cast<Uint32>(key.hinting) << 16 | static_cast<Uint32>(key.sdf) << 8 | static_cast<Uint32>(key.mode);
+    h ^= std::hash<Uint32>{}(variant) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+namespace {
+
+// The parts of a font's state a GlyphKey records besides the codepoint.
+struct FontState {
+    float size;
+    TTF_HintingFlags hinting;
+    bool sdf;
+
+    static FontState of(TTF_Font* font) { return FontState{TTF_GetFontSize(font), TTF_GetFontHinting(font), TTF_GetFontSDF(font)}; }
+    static FontState of(const GlyphKey& key) { return FontState{key.size, key.hinting, key.sdf}; }
+
+    // Each setter flushes the font's glyph cache, so only call the ones
+    // that change something.
+    void apply(TTF_Font* font) const {
+        const FontState current = of(font);
+        if (current.size != size) {
+            TTF_SetFontSize(font, size);
+        }
+        if (current.hinting != hinting) {
+            TTF_SetFontHinting(font, hinting);
+        }
+        if (current.sdf != sdf) {
+            TTF_SetFontSDF(font, sdf);
+        }
+    }
+};
+
+} // namespace
+
+Glyph place_glyph(int page, const SDL_Rect& slot, const GlyphBitmap& bitmap, int padding, int page_size) {
+    const auto size = static_cast<float>(page_size);
+    Glyph glyph;
+    glyph.page = page;
+    glyph.rect = SDL_Rect{slot.x + padding, slot.y + padding, bitmap.ink.w, bitmap.ink.h};
+    glyph.uv = SDL_FRect{glyph.rect.x / size, glyph.rect.y / size, glyph.rect.w / size, glyph.rect.h / size};
+    glyph.offset_x = bitmap.ink.x;
+    glyph.offset_y = bitmap.ink.y;
+    glyph.advance = bitmap.advance;
+    return glyph;
+}
+
+void ensure_quad_indices(std::vector<int>& indices, std::size_t quads) {
+    for (std::size_t quad = indices.size() / 6; quad < quads; ++quad) {
+        const int base = static_cast<int>(quad * 4);
+        indices.insert(indices.end(), {base, base + 1, base + 2, base + 2, base + 1, base + 3});
+    }
+}
+
+GlyphAtlas::GlyphAtlas(SDL_Renderer* renderer)
+    : GlyphAtlas(renderer, Config{}) {}
+
+GlyphAtlas::GlyphAtlas(SDL_Renderer* renderer, Config config)
+    : renderer_(renderer), config_(config) {}
+
+GlyphAtlas::GlyphAtlas(SDL_GPUDevice* device, Config config)
+    : device_(device), config_(config) {}
+
+GlyphAtlas::~GlyphAtlas() {
+    for (Page& page : pages_) {
+        if (page.texture != nullptr) {
+            SDL_DestroyTexture(page.texture);
+        }
+        if (page.gpu_texture != nullptr) {
+            SDL_ReleaseGPUTexture(device_, page.gpu_texture);
+        }
+    }
+}
+
+void GlyphAtlas::begin_frame() {
+    ++frame_;
+    looked_up_ = false;
+}
+
+const Glyph* GlyphAtlas::lookup(TTF_Font* font, Uint32 codepoint) {
+    looked_up_ = true;
+    const GlyphKey key = GlyphKey::of(font, codepoint, render_mode_);
+    const auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        it->second.last_used_frame = frame_;
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        ++text_stats().glyph_hits;
+        return &it->second.glyph;
+    }
+    ++text_stats().glyph_misses;
+    return rasterize(key);
+}
+
+void GlyphAtlas::clear() {
+    entries_.clear();
+    lru_.clear();
+    free_slots_.clear();
+    used_area_ = 0;
+    defrag_page_ = -1;
+    for (Page& page : pages_) {
+        page.packer.reset();
+        page.used_area = 0;
+    }
+}
+
+void GlyphAtlas::forget(TTF_Font* font) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->first.font != font) {
+            ++it;
+            continue;
+        }
+        if (it->second.slot.page >= 0) {
+            remove_used(it->second.slot);
+            free_slots_.push_back(it->second.slot);
+        }
+        lru_.erase(it->second.lru);
+        it = entries_.erase(it);
+    }
+}
+
+float GlyphAtlas::occupancy() const {
+    const auto page_area = static_cast<std::size_t>(config_.page_size) * config_.page_size;
+    return live_pages_ == 0 ? 0.0f : static_cast<float>(used_area_) / static_cast<float>(page_area * live_pages_);
+}
+
+bool GlyphAtlas::defragment(int max_glyphs) {
+    if (looked_up_) {
+        return defrag_page_ >= 0;
+    }
+    if (defrag_page_ < 0 && (defrag_page_ = pick_defrag_page()) < 0) {
+        return false;
+    }
+    TRACE_SCOPE("GlyphAtlas::defragment");
+    // Keys first: re-rasterizing inserts into entries_.
+    std::vector<GlyphKey> keys;
+    for (const auto& [key, entry] : entries_) {
+        if (entry.slot.page == defrag_page_) {
+            keys.push_back(key);
+            if (static_cast<int>(keys.size()) == max_glyphs) {
+                break;
+            }
+        }
+    }
+    // The glyphs may have been rasterized at other sizes or under another
+    // quality tier than the font is set to now. Group them by that state so
+    // each font is switched to it once, and put the font back afterwards.
+    std::sort(keys.begin(), keys.end(), [](const GlyphKey& a, const GlyphKey& b) {
+        return std::tie(a.font, a.size, a.hinting, a.sdf) < std::tie(b.font, b.size, b.hinting, b.sdf);
+    });
+    TTF_Font* switched = nullptr;
+    FontState saved{};
+    const auto restore = [&] {
+        if (switched != nullptr) {
+            saved.apply(switched);
+        }
+        switched = nullptr;
+    };
+    for (const GlyphKey& key : keys) {
+        const auto it = entries_.find(key);
+        // Allocating for an earlier glyph may have evicted this one.
+        if (it == entries_.end() || it->second.slot.page != defrag_page_) {
+            continue;
+        }
+        const Uint64 last_used = it->second.last_used_frame;
+        // The hole is reusable once this page is no longer being emptied,
+        // or goes with the page when it is released.
+        remove_used(it->second.slot);
+        free_slots_.push_back(it->second.slot);
+        lru_.erase(it->second.lru);
+        entries_.erase(it);
+        if (last_used + config_.cold_frames < frame_) {
+            continue;
+        }
+        if (key.font != switched) {
+            restore();
+            switched = key.font;
+            saved = FontState::of(key.font);
+        }
+        FontState::of(key).apply(key.font);
+        GlyphBitmap bitmap;
+        if (!rasterize_glyph(key.font, key.codepoint, bitmap, key.mode)) {
+            // Dropped; its next lookup reports the error.
+            SDL_Log("GlyphAtlas: failed to render U+%04X: %s", key.codepoint, SDL_GetError());
+            continue;
+        }
+        Entry* entry = insert(key, bitmap);
+        if (entry == nullptr) {
+            // No room elsewhere; the page stays. The glyph comes back on its
+            // next lookup.
+            restore();
+            defrag_page_ = -1;
+            return false;
+        }
+        entry->last_used_frame = last_used;
+    }
+    restore();
+    if (pages_[defrag_page_].used_area == 0) {
+        release_page(defrag_page_);
+        defrag_page_ = -1;
+    }
+    return defrag_page_ >= 0;
+}
+
+std::size_t GlyphAtlas::memory_used() const {
+    std::size_t bytes = static_cast<std::size_t>(live_pages_) * config_.page_size * config_.page_size * 4;
+    for (const Page& page : pages_) {
+        bytes += page.mirror.capacity() * sizeof(Uint32);
+    }
+    return bytes + staging_.capacity() * sizeof(Uint32) + pending_pixels_.capacity();
+}
+
+void GlyphAtlas::set_memory_limit(std::size_t bytes) {
+    memory_limit_ = bytes;
+    trim_pages();
+}
+
+std::size_t GlyphAtlas::page_bytes() const {
+    const std::size_t texels = static_cast<std::size_t>(config_.page_size) * config_.page_size;
+    return texels * (device_ == nullptr && config_.coalesce_uploads ? 8 : 4);
+}
+
+int GlyphAtlas::page_limit() const {
+    const std::size_t fit = memory_limit_ / page_bytes();
+    return static_cast<int>(std::clamp<std::size_t>(fit, 1, static_cast<std::size_t>(std::max(config_.max_pages, 1))));
+}
+
+void GlyphAtlas::trim_pages() {
+    while (live_pages_ > page_limit()) {
+        // Pages with a glyph queued this frame have to stay.
+        std::vector<bool> busy(pages_.size(), false);
+        for (const auto& [key, entry] : entries_) {
+            if (entry.slot.page >= 0 && entry.last_used_frame == frame_) {
+                busy[entry.slot.page] = true;
+            }
+        }
+        int sparsest = -1;
+        for (int page = 0; page < page_count(); ++page) {
+            if (pages_[page].live() && !busy[page] && (sparsest < 0 || pages_[page].used_area < pages_[sparsest].used_area)) {
+                sparsest = page;
+            }
+        }
+        if (sparsest < 0) {
+            SDL_Log("GlyphAtlas: every page is in use this frame, %d pages kept over the memory limit", live_pages_ - page_limit());
+            return;
+        }
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (it->second.slot.page != sparsest) {
+                ++it;
+                continue;
+            }
+            remove_used(it->second.slot);
+            lru_.erase(it->second.lru);
+            it = entries_.erase(it);
+        }
+        if (defrag_page_ == sparsest) {
+            defrag_page_ = -1;
+        }
+        release_page(sparsest);
+    }
+}
+
+int GlyphAtlas::pick_defrag_page() const {
+    if (live_pages_ < 2) {
+        return -1;
+    }
+    const auto page_area = static_cast<std::size_t>(config_.page_size) * config_.page_size;
+    // Packing never reaches 100%, so leave some slack on the remaining pages.
+    if (static_cast<double>(used_area_) > 0.85 * static_cast<double>(page_area * (live_pages_ - 1))) {
+        return -1;
+    }
+    int sparsest = -1;
+    for (int page = 0; page < page_count(); ++page) {
+        if (pages_[page].live() && (sparsest < 0 || pages_[page].used_area < pages_[sparsest].used_area)) {
+            sparsest = page;
+        }
+    }
+    const float occupied = static_cast<float>(pages_[sparsest].used_area) / static_cast<float>(page_area);
+    return occupied < config_.defrag_occupancy ? sparsest : -1;
+}
+
+void GlyphAtlas::release_page(int page) {
+    Page& released = pages_[page];
+    if (released.texture != nullptr) {
+        SDL_DestroyTexture(released.texture);
+        released.texture = nullptr;
+    }
+    if (released.gpu_texture != nullptr) {
+        SDL_ReleaseGPUTexture(device_, released.gpu_texture);
+        released.gpu_texture = nullptr;
+    }
+    released.packer.reset();
+    released.mirror = {};
+    released.dirty = SDL_Rect{0, 0, 0, 0};
+    --live_pages_;
+    std::erase_if(free_slots_, [page](const Slot& slot) { return slot.page == page; });
+    std::erase_if(pending_, [page](const PendingUpload& upload) { return upload.page == page; });
+}
+
+void GlyphAtlas::add_used(const Slot& slot) {
+    const auto area = static_cast<std::size_t>(slot.rect.w) * slot.rect.h;
+    used_area_ += area;
+    pages_[slot.page].used_area += area;
+}
+
+void GlyphAtlas::remove_used(const Slot& slot) {
+    const auto area = static_cast<std::size_t>(slot.rect.w) * slot.rect.h;
+    used_area_ -= area;
+    pages_[slot.page].used_area -= area;
+}
+
+bool GlyphAtlas::adopt_page(TTF_Font* font, const AtlasPageImage& image) {
+    TRACE_SCOPE("GlyphAtlas::adopt_page");
+    if (image.surface == nullptr || image.surface->w != config_.page_size || image.surface->h != config_.page_size) {
+        return false;
+    }
+    if (live_pages_ >= page_limit()) {
+        SDL_Log("GlyphAtlas: page limit reached, prebuilt page dropped");
+        return false;
+    }
+    const int page = add_page(image.packer);
+    if (page < 0) {
+        return false;
+    }
+    upload(page, nullptr, image.surface->pixels, image.surface->pitch);
+    // Prebuilt pages are always blended, with the font's current hinting.
+    const GlyphKey base = GlyphKey::of(font, 0, GlyphRenderMode::blended);
+    for (const PrebuiltGlyph& prebuilt : image.glyphs) {
+        GlyphKey key = base;
+        key.codepoint = prebuilt.codepoint;
+        if (entries_.contains(key)) {
+            continue;
+        }
+        Glyph glyph = prebuilt.glyph;
+        Slot slot{-1, prebuilt.slot};
+        if (glyph.page >= 0) {
+            glyph.page = page;
+            slot.page = page;
+            add_used(slot);
+        }
+        // Prewarmed glyphs start out cold so unused ones are evicted first.
+        lru_.push_back(key);
+        entries_.emplace(key, Entry{glyph, slot, 0, std::prev(lru_.end())});
+    }
+    return true;
+}
+
+const Glyph* GlyphAtlas::rasterize(const GlyphKey& key) {
+    TRACE_SCOPE("GlyphAtlas::rasterize");
+    GlyphBitmap bitmap;
+    if (!rasterize_glyph(key.font, key.codepoint, bitmap, key.mode)) {
+        SDL_Log("GlyphAtlas: failed to render U+%04X: %s", key.codepoint, SDL_GetError());
+        return nullptr;
+    }
+    Entry* entry = insert(key, bitmap);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+    entry->last_used_frame = frame_;
+    return &entry->glyph;
+}
+
+int GlyphAtlas::drain_uploads(GlyphUploadQueue& queue, Uint64 budget_ns) {
+    TRACE_SCOPE("GlyphAtlas::drain_uploads");
+    const Uint64 deadline = SDL_GetTicksNS() + budget_ns;
+    int added = 0;
+    do {
+        std::optional<StagedGlyph> staged = queue.pop();
+        if (!staged) {
+            break;
+        }
+        if (entries_.contains(staged->key)) {
+            SDL_DestroySurface(staged->bitmap.surface);
+            continue;
+        }
+        Entry* entry = insert(staged->key, staged->bitmap);
+        if (entry == nullptr) {
+            continue;
+        }
+        // A worker staged it because it is about to be drawn, so it is as
+        // warm as a lookup, and a later glyph in this drain cannot evict it.
+        entry->last_used_frame = frame_;
+        ++added;
+    } while (SDL_GetTicksNS() < deadline);
+    return added;
+}
+
+GlyphAtlas::Entry* GlyphAtlas::insert(const GlyphKey& key, GlyphBitmap& bitmap) {
+    Glyph glyph;
+    glyph.advance = bitmap.advance;
+    Slot slot{-1, SDL_Rect{0, 0, 0, 0}};
+    if (bitmap.surface != nullptr) {
+        const SDL_Rect& ink = bitmap.ink;
+        const int pad = config_.padding;
+        if (!allocate(ink.w + 2 * pad, ink.h + 2 * pad, slot)) {
+            SDL_Log("GlyphAtlas: no space for U+%04X", key.codepoint);
+            SDL_DestroySurface(bitmap.surface);
+            bitmap.surface = nullptr;
+            return nullptr;
+        }
+        // Upload the whole slot so a reused slot never keeps stale pixels
+        // from the glyph that was evicted from it.
+        staging_.assign(static_cast<std::size_t>(slot.rect.w) * slot.rect.h, 0);
+        copy_glyph_ink(bitmap, staging_.data(), slot.rect.w * 4, pad, pad);
+        upload(slot.page, &slot.rect, staging_.data(), slot.rect.w * 4);
+        add_used(slot);
+        SDL_DestroySurface(bitmap.surface);
+        bitmap.surface = nullptr;
+
+        glyph = place_glyph(slot.page, slot.rect, bitmap, pad, config_.page_size);
+    }
+    lru_.push_front(key);
+    Entry& entry = entries_[key];
+    entry = Entry{glyph, slot, 0, lru_.begin()};
+    return &entry;
+}
+
+bool GlyphAtlas::allocate(int w, int h, Slot& slot) {
+    if (w > config_.page_size || h > config_.page_size) {
+        return false;
+    }
+    if (allocate_from_free(w, h, slot)) {
+        return true;
+    }
+    for (int page = 0; page < page_count(); ++page) {
+        if (page != defrag_page_ && pages_[page].live() && pages_[page].packer.pack(w, h, slot.rect)) {
+            slot.page = page;
+            return true;
+        }
+    }
+    if (live_pages_ < page_limit()) {
+        slot.page = add_page(SkylinePacker(config_.page_size));
+        if (slot.page >= 0 && pages_[slot.page].packer.pack(w, h, slot.rect)) {
+            return true;
+        }
+    }
+    while (evict_one()) {
+        if (allocate_from_free(w, h, slot)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GlyphAtlas::allocate_from_free(int w, int h, Slot& slot) {
+    auto best = free_slots_.end();
+    for (auto it = free_slots_.begin(); it != free_slots_.end(); ++it) {
+        if (it->page != defrag_page_ && it->rect.w >= w && it->rect.h >= h && (best == free_slots_.end() || it->rect.w * it->rect.h < best->rect.w * best->rect.h)) {
+            best = it;
+        }
+    }
+    if (best == free_slots_.end()) {
+        return false;
+    }
+    slot = *best;
+    *best = free_slots_.back();
+    free_slots_.pop_back();
+    return true;
+}
+
+int GlyphAtlas::add_page(const SkylinePacker& packer) {
+    Page page{nullptr, nullptr, packer};
+    if (device_ != nullptr) {
+        // ARGB8888 is B, G, R, A in memory on the little-endian targets
+        // SDL_GPU runs on.
+        SDL_GPUTextureCreateInfo info{};
+        info.type = SDL_GPU_TEXTURETYPE_2D;
+        info.format = SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM;
+        info.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER;
+        info.width = static_cast<Uint32>(config_.page_size);
+        info.height = static_cast<Uint32>(config_.page_size);
+        info.layer_count_or_depth = 1;
+        info.num_levels = 1;
+        page.gpu_texture = SDL_CreateGPUTexture(device_, &info);
+    } else {
+        page.texture = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, config_.page_size, config_.page_size);
+        if (page.texture != nullptr) {
+            SDL_SetTextureBlendMode(page.texture, SDL_BLENDMODE_BLEND);
+        }
+    }
+    if (page.texture == nullptr && page.gpu_texture == nullptr) {
+        SDL_Log("GlyphAtlas: failed to create page: %s", SDL_GetError());
+        return -1;
+    }
+    ++live_pages_;
+    // Reuse the index of a released page so indices stay small.
+    for (int index = 0; index < page_count(); ++index) {
+        if (!pages_[index].live()) {
+            pages_[index] = page;
+            return index;
+        }
+    }
+    pages_.push_back(page);
+    return page_count() - 1;
+}
+
+void GlyphAtlas::upload(int page, const SDL_Rect* rect, const void* pixels, int pitch) {
+    const SDL_Rect area = rect != nullptr ? *rect : SDL_Rect{0, 0, config_.page_size, config_.page_size};
+    const std::size_t row_bytes = static_cast<std::size_t>(area.w) * 4;
+    if (device_ == nullptr && config_.coalesce_uploads) {
+        Page& target = pages_[page];
+        const auto size = static_cast<std::size_t>(config_.page_size);
+        target.mirror.resize(size * size);
+        for (int row = 0; row < area.h; ++row) {
+            std::memcpy(target.mirror.data() + (area.y + row) * size + area.x, static_cast<const Uint8*>(pixels) + row * pitch, row_bytes);
+        }
+        if (SDL_RectEmpty(&target.dirty)) {
+            target.dirty = area;
+        } else {
+            SDL_GetRectUnion(&target.dirty, &area, &target.dirty);
+        }
+        return;
+    }
+    text_stats().bytes_uploaded += row_bytes * area.h;
+    if (device_ == nullptr) {
+        SDL_UpdateTexture(pages_[page].texture, rect, pixels, pitch);
+        return;
+    }
+    const std::size_t offset = pending_pixels_.size();
+    pending_pixels_.resize(offset + row_bytes * area.h);
+    for (int row = 0; row < area.h; ++row) {
+        std::memcpy(pending_pixels_.data() + offset + row * row_bytes, static_cast<const Uint8*>(pixels) + row * pitch, row_bytes);
+    }
+    pending_.push_back(PendingUpload{page, area, offset});
+}
+
+void GlyphAtlas::flush_uploads() {
+    const auto size = static_cast<std::size_t>(config_.page_size);
+    for (Page& page : pages_) {
+        if (SDL_RectEmpty(&page.dirty)) {
+            continue;
+        }
+        const SDL_Rect& dirty = page.dirty;
+        SDL_UpdateTexture(page.texture, &dirty, page.mirror.data() + dirty.y * size + dirty.x, static_cast<int>(size * 4));
+        text_stats().bytes_uploaded += static_cast<std::size_t>(dirty.w) * dirty.h * 4;
+        page.dirty = SDL_Rect{0, 0, 0, 0};
+    }
+}
+
+void GlyphAtlas::clear_pending_uploads() {
+    pending_.clear();
+    pending_pixels_.clear();
+}
+
+bool GlyphAtlas::evict_one() {
+    if (lru_.empty()) {
+        return false;
+    }
+    const auto it = entries_.find(lru_.back());
+    if (it->second.last_used_frame == frame_) {
+        return false;
+    }
+    if (const Slot& slot = it->second.slot; slot.page >= 0) {
+        free_slots_.push_back(slot);
+        remove_used(slot);
+    }
+    entries_.erase(it);
+    lru_.pop_back();
+    return true;
+}
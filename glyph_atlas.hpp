@@ -0,0 +1,290 @@
+
+#pragma once
+
+#include "glyph_raster.hpp"
+#include "skyline_packer.hpp"
+
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_render.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Identifies one rasterized glyph. The size, hinting, SDF flag and render
+// mode are part of the key so a single TTF_Font that is resized or switched
+// between quality tiers keeps separate entries for each.
+struct GlyphKey {
+    TTF_Font* font;
+    float size;
+    Uint32 codepoint;
+    TTF_HintingFlags hinting = TTF_HINTING_NORMAL;
+    bool sdf = false;
+    GlyphRenderMode mode = GlyphRenderMode::blended;
+
+    // The key font's current size, hinting and SDF flag.
+    static GlyphKey of(TTF_Font* font, Uint32 codepoint, GlyphRenderMode mode);
+
+    bool operator==(const GlyphKey&) const = default;
+};
+
+struct GlyphKeyHash {
+    std::size_t operator()(const GlyphKey& key) const noexcept;
+};
+
+// Where a glyph lives in the atlas and how to place it relative to the pen.
+// Offsets are from the top-left of the line cell TTF_RenderGlyph_* produces.
+struct Glyph {
+    int page = -1;
+    SDL_Rect rect{};
+    SDL_FRect uv{};
+    int offset_x = 0;
+    int offset_y = 0;
+    int advance = 0;
+};
+
+// Appends the four corners of a glyph quad drawn with its line cell at (x, y).
+// Scaled quads are stretched by scale around that corner, for glyphs
+// rasterized at a reference size and drawn at another; unscaled ones ignore
+// scale. Callers pick the variant once per run, so the per-glyph code is
+// straight-line.
+template <bool Scaled>
+void append_glyph_quad(std::vector<SDL_Vertex>& vertices, const Glyph& glyph, float x, float y, SDL_FColor color, float scale) {
+    float left = x + static_cast<float>(glyph.offset_x);
+    float top = y + static_cast<float>(glyph.offset_y);
+    float w = static_cast<float>(glyph.rect.w);
+    float h = static_cast<float>(glyph.rect.h);
+    if constexpr (Scaled) {
+        left = x + static_cast<float>(glyph.offset_x) * scale;
+        top = y + static_cast<float>(glyph.offset_y) * scale;
+        w *= scale;
+        h *= scale;
+    }
+    const float u0 = glyph.uv.x;
+    const float v0 = glyph.uv.y;
+    const float u1 = glyph.uv.x + glyph.uv.w;
+    const float v1 = glyph.uv.y + glyph.uv.h;
+    const SDL_Vertex quad[4] = {
+        {{left, top}, color, {u0, v0}},
+        {{left + w, top}, color, {u1, v0}},
+        {{left, top + h}, color, {u0, v1}},
+        {{left + w, top + h}, color, {u1, v1}},
+    };
+    vertices.insert(vertices.end(), quad, quad + 4);
+}
+
+class GlyphUploadQueue;
+
+// Describes a bitmap stored in the padded packer cell slot of a page.
+Glyph place_glyph(int page, const SDL_Rect& slot, const GlyphBitmap& bitmap, int padding, int page_size);
+
+// Grows a shared index buffer so it covers at least `quads` quads.
+void ensure_quad_indices(std::vector<int>& indices, std::size_t quads);
+
+// A glyph already placed on an AtlasPageImage. slot is the packer cell it
+// occupies; a glyph without ink has an empty slot.
+struct PrebuiltGlyph {
+    Uint32 codepoint;
+    SDL_Rect slot;
+    Glyph glyph;
+};
+
+// A page rasterized away from the render thread, ready to become a GPU
+// page. The surface is page_size square ARGB8888 and the packer carries on
+// from where the builder stopped so the rest of the page can still be used.
+struct AtlasPageImage {
+    SDL_Surface* surface = nullptr;
+    SkylinePacker packer{0};
+    std::vector<PrebuiltGlyph> glyphs;
+};
+
+// Caches rasterized glyphs in a few fixed-size RGBA textures. Glyphs are
+// rasterized on first use, packed with a SkylinePacker, and the least
+// recently used ones are evicted when every page is full. Glyphs used since
+// the last begin_frame() are never evicted, so quads queued for the current
+// frame stay valid.
+//
+// defragment() shrinks the atlas again after a burst of glyphs, e.g. one
+// screen of CJK text in a long session, by emptying sparse pages a few
+// glyphs per frame and releasing their textures.
+//
+// Pages are SDL_Renderer textures, or SDL_GPU textures when the atlas is
+// created for a GPU device. SDL_GPU uploads have to be recorded in a copy
+// pass, so in that mode new glyph pixels are queued as pending uploads for
+// the GPU backend to submit before it draws.
+//
+// With coalesce_uploads, renderer pages keep a CPU copy of their pixels and
+// new glyphs are only written there; flush_uploads(), which TextBatch calls
+// before drawing, then sends each page's changed area in a single
+// SDL_UpdateTexture. That costs page_size * page_size * 4 bytes per page
+// and turns a frame with hundreds of new glyphs into one upload per page.
+class GlyphAtlas {
+public:
+    struct Config {
+        int page_size = 1024;
+        int max_pages = 4;
+        int padding = 1;
+        // defragment() empties a page once that page is less than this full
+        // and the live glyphs would fit on one page fewer.
+        float defrag_occupancy = 0.5f;
+        // Glyphs unused for this many frames are dropped by defragment()
+        // rather than moved.
+        Uint64 cold_frames = 600;
+        // Renderer mode only; see the class comment.
+        bool coalesce_uploads = false;
+    };
+
+    // Pixels waiting to be copied into GPU page `page` at rect. They start
+    // at offset in pending_pixels(), rect.w * 4 bytes per row.
+    struct PendingUpload {
+        int page;
+        SDL_Rect rect;
+        std::size_t offset;
+    };
+
+    explicit GlyphAtlas(SDL_Renderer* renderer);
+    GlyphAtlas(SDL_Renderer* renderer, Config config);
+    GlyphAtlas(SDL_GPUDevice* device, Config config);
+    ~GlyphAtlas();
+
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    void begin_frame();
+
+    // How glyphs missing from the atlas are rasterized from now on. Glyphs
+    // of each mode are kept apart, so switching back finds the old ones
+    // until they are evicted.
+    void set_render_mode(GlyphRenderMode mode) { render_mode_ = mode; }
+    GlyphRenderMode render_mode() const { return render_mode_; }
+
+    // Returns nullptr if the glyph could not be rasterized or no space could
+    // be freed for it. The pointer is valid until the next lookup.
+    const Glyph* lookup(TTF_Font* font, Uint32 codepoint);
+
+    // Uploads a prebuilt page for font at its current size and registers its
+    // glyphs. Glyphs the atlas already holds are skipped. Fails if the page
+    // limit has been reached or the image does not match the page size.
+    bool adopt_page(TTF_Font* font, const AtlasPageImage& image);
+
+    // Adds glyphs staged by worker threads until the queue is empty or
+    // budget_ns has passed, always taking at least one. Glyphs the atlas
+    // already holds are dropped. Added glyphs count as used this frame, so
+    // they are not evicted before they are drawn. Returns the number added.
+    int drain_uploads(GlyphUploadQueue& queue, Uint64 budget_ns);
+
+    // Sends the pixels coalesced since the last flush to the page textures.
+    // Does nothing unless coalesce_uploads is set.
+    void flush_uploads();
+
+    // Moves up to max_glyphs glyphs off the sparsest page, dropping cold
+    // ones and re-rasterizing the rest onto other pages, and releases the
+    // page's texture once it is empty. Call right after begin_frame(),
+    // before any lookup, so no queued quad refers to a moved glyph; it does
+    // nothing otherwise. Returns true while a page is being emptied. The
+    // fonts of the glyphs held must still be open, as for lookup(). Glyphs
+    // are re-rasterized at the size, hinting and SDF setting of their key,
+    // so a font is switched to those briefly and then restored; it must not
+    // be in use on another thread meanwhile.
+    bool defragment(int max_glyphs = 32);
+
+    // Drops every glyph rasterized from font, e.g. from a
+    // FontManager::on_close() listener.
+    void forget(TTF_Font* font);
+
+    // Texture and staging memory held, counting each page at 4 bytes per
+    // texel (twice that with coalesce_uploads).
+    std::size_t memory_used() const;
+
+    // Caps the pages kept, below max_pages, at what fits in bytes, and at
+    // least one. Pages over the cap are emptied and released at once,
+    // sparsest first, except those holding glyphs looked up this frame.
+    void set_memory_limit(std::size_t bytes);
+
+    SDL_Renderer* renderer() const { return renderer_; }
+    SDL_GPUDevice* device() const { return device_; }
+    const Config& config() const { return config_; }
+    // Page indices in use, including released pages, whose textures are
+    // nullptr and which hold no glyphs.
+    int page_count() const { return static_cast<int>(pages_.size()); }
+    // Pages holding a texture.
+    int live_page_count() const { return live_pages_; }
+    SDL_Texture* page_texture(int page) const { return pages_[page].texture; }
+    SDL_GPUTexture* gpu_page_texture(int page) const { return pages_[page].gpu_texture; }
+    std::size_t glyph_count() const { return entries_.size(); }
+    // Fraction of the allocated pages' area held by live glyphs.
+    float occupancy() const;
+
+    void clear();
+
+    // GPU mode only: uploads queued since clear_pending_uploads(), in the
+    // order they must be applied.
+    const std::vector<PendingUpload>& pending_uploads() const { return pending_; }
+    const Uint8* pending_pixels() const { return pending_pixels_.data(); }
+    std::size_t pending_bytes() const { return pending_pixels_.size(); }
+    void clear_pending_uploads();
+
+private:
+    struct Page {
+        SDL_Texture* texture;
+        SDL_GPUTexture* gpu_texture;
+        SkylinePacker packer;
+        std::size_t used_area = 0;
+        // coalesce_uploads only: the page's pixels and the part of them
+        // not yet sent to the texture.
+        std::vector<Uint32> mirror{};
+        SDL_Rect dirty{0, 0, 0, 0};
+
+        bool live() const { return texture != nullptr || gpu_texture != nullptr; }
+    };
+
+    struct Slot {
+        int page;
+        SDL_Rect rect;
+    };
+
+    struct Entry {
+        Glyph glyph;
+        Slot slot;
+        Uint64 last_used_frame;
+        std::list<GlyphKey>::iterator lru;
+    };
+
+    const Glyph* rasterize(const GlyphKey& key);
+    // Places bitmap, taking its surface, and returns the new entry.
+    Entry* insert(const GlyphKey& key, GlyphBitmap& bitmap);
+    bool allocate(int w, int h, Slot& slot);
+    bool allocate_from_free(int w, int h, Slot& slot);
+    // Returns the index of the new page, or -1.
+    int add_page(const SkylinePacker& packer);
+    void release_page(int page);
+    int pick_defrag_page() const;
+    int page_limit() const;
+    std::size_t page_bytes() const;
+    void trim_pages();
+    void add_used(const Slot& slot);
+    void remove_used(const Slot& slot);
+    void upload(int page, const SDL_Rect* rect, const void* pixels, int pitch);
+    bool evict_one();
+
+    SDL_Renderer* renderer_ = nullptr;
+    SDL_GPUDevice* device_ = nullptr;
+    Config config_;
+    std::vector<Page> pages_;
+    std::vector<Slot> free_slots_;
+    std::unordered_map<GlyphKey, Entry, GlyphKeyHash> entries_;
+    std::list<GlyphKey> lru_;
+    Uint64 frame_ = 0;
+    GlyphRenderMode render_mode_ = GlyphRenderMode::blended;
+    bool looked_up_ = false;
+    std::size_t used_area_ = 0;
+    int live_pages_ = 0;
+    std::size_t memory_limit_ = static_cast<std::size_t>(-1);
+    // The page defragment() is emptying, which allocation avoids.
+    int defrag_page_ = -1;
+    std::vector<Uint32> staging_;
+    std::vector<PendingUpload> pending_;
+    std::vector<Uint8> pending_pixels_;
+};
@@ -0,0 +1,95 @@
+
+#include "glyph_raster.hpp"
+
+#include "text_stats.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr SDL_Color white{255, 255, 255, 255};
+// Shaded palettes blend alpha too, so a transparent white background leaves
+// coverage in alpha like the blended renderer.
+constexpr SDL_Color clear_white{255, 255, 255, 0};
+
+// Smallest rectangle containing every pixel with non-zero alpha.
+SDL_Rect ink_bounds(const SDL_Surface* surface) {
+    int min_x = surface->w;
+    int min_y = surface->h;
+    int max_x = -1;
+    int max_y = -1;
+    for (int y = 0; y < surface->h; ++y) {
+        const auto* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(surface->pixels) + y * surface->pitch);
+        for (int x = 0; x < surface->w; ++x) {
+            if ((row[x] >> 24) != 0) {
+                min_x = std::min(min_x, x);
+                max_x = std::max(max_x, x);
+                min_y = std::min(min_y, y);
+                max_y = y;
+            }
+        }
+    }
+    if (max_x < 0) {
+        return SDL_Rect{0, 0, 0, 0};
+    }
+    return SDL_Rect{min_x, min_y, max_x - min_x + 1, max_y - min_y + 1};
+}
+
+} // namespace
+
+bool rasterize_glyph(TTF_Font* font, Uint32 codepoint, GlyphBitmap& bitmap, GlyphRenderMode mode) {
+    bitmap = GlyphBitmap{};
+    int min_x = 0;
+    int max_x = 0;
+    int min_y = 0;
+    int max_y = 0;
+    SDL_Surface* surface = nullptr;
+    {
+        TtfTimer timer;
+        if (!TTF_GetGlyphMetrics(font, codepoint, &min_x, &max_x, &min_y, &max_y, &bitmap.advance)) {
+            return false;
+        }
+        if (max_x <= min_x || max_y <= min_y) {
+            return true;
+        }
+        switch (mode) {
+        case GlyphRenderMode::blended:
+            surface = TTF_RenderGlyph_Blended(font, codepoint, white);
+            break;
+        case GlyphRenderMode::shaded:
+            surface = TTF_RenderGlyph_Shaded(font, codepoint, white, clear_white);
+            break;
+        case GlyphRenderMode::solid:
+            surface = TTF_RenderGlyph_Solid(font, codepoint, white);
+            break;
+        }
+    }
+    if (surface == nullptr) {
+        return false;
+    }
+    if (surface->format != SDL_PIXELFORMAT_ARGB8888) {
+        SDL_Surface* converted = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_ARGB8888);
+        SDL_DestroySurface(surface);
+        if (converted == nullptr) {
+            return false;
+        }
+        surface = converted;
+    }
+    bitmap.ink = ink_bounds(surface);
+    if (bitmap.ink.w == 0) {
+        SDL_DestroySurface(surface);
+        return true;
+    }
+    bitmap.surface = surface;
+    return true;
+}
+
+void copy_glyph_ink(const GlyphBitmap& bitmap, void* dst_pixels, int dst_pitch, int x, int y) {
+    const SDL_Rect& ink = bitmap.ink;
+    for (int row = 0; row < ink.h; ++row) {
+        const auto* src = static_cast<const Uint8*>(bitmap.surface->pixels) + (ink.y + row) * bitmap.surface->pitch + ink.x * 4;
+        auto* dst = static_cast<Uint8*>(dst_pixels) + (y + row) * dst_pitch + x * 4;
+        std::memcpy(dst, src, static_cast<std::size_t>(ink.w) * 4);
+    }
+}
@@ -0,0 +1,39 @@
+
+#pragma once
+
+#include <SDL3/SDL_surface.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+// A glyph rendered white-on-transparent in SDL_PIXELFORMAT_ARGB8888. The
+// surface is the line cell TTF_RenderGlyph_Blended produces and ink is the
+// part of it with coverage. Glyphs without ink, such as spaces, have no
+// surface.
+struct GlyphBitmap {
+    SDL_Surface* surface = nullptr;
+    SDL_Rect ink{0, 0, 0, 0};
+    int advance = 0;
+};
+
+// How rasterize_glyph() renders coverage, from best to cheapest: 32-bit
+// blended, 8-bit shaded (TTF_RenderGlyph_Shaded) and 1-bit solid. All
+// three come out as ARGB8888 with coverage in alpha.
+enum class GlyphRenderMode : Uint8 {
+    blended,
+    shaded,
+    solid,
+};
+
+// Distance in pixels, at the font's size, that an SDF glyph's field covers
+// on either side of the outline. This is FreeType's default spread, which
+// SDL3_ttf does not change. Alpha 128 lies on the outline and each step of
+// 128 / sdf_spread is one pixel further inside (up) or outside (down).
+inline constexpr int sdf_spread = 8;
+
+// Fills bitmap for one codepoint. For fonts with TTF_SetFontSDF enabled
+// the alpha channel holds the distance field and ink includes its spread.
+// The caller owns and destroys bitmap.surface. Returns false with the SDL
+// error set if the font cannot produce the glyph.
+bool rasterize_glyph(TTF_Font* font, Uint32 codepoint, GlyphBitmap& bitmap, GlyphRenderMode mode = GlyphRenderMode::blended);
+
+// Copies the ink of bitmap into a 32-bit destination at (x, y).
+void copy_glyph_ink(const GlyphBitmap& bitmap, void* dst_pixels, int dst_pitch, int x, int y);
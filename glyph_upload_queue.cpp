@@ -0,0 +1,33 @@
+
+#include "glyph_upload_queue.hpp"
+
+#include <utility>
+
+GlyphUploadQueue::GlyphUploadQueue(std::size_t capacity)
+    : queue_(capacity) {}
+
+GlyphUploadQueue::~GlyphUploadQueue() {
+    while (std::optional<StagedGlyph> glyph = queue_.pop()) {
+        SDL_DestroySurface(glyph->bitmap.surface);
+    }
+}
+
+bool GlyphUploadQueue::stage(TTF_Font* font, TTF_Font* face, Uint32 codepoint, GlyphRenderMode mode) {
+    StagedGlyph glyph{GlyphKey{font, TTF_GetFontSize(face), codepoint, TTF_GetFontHinting(face), TTF_GetFontSDF(face), mode}, {}};
+    if (!rasterize_glyph(face, codepoint, glyph.bitmap, mode)) {
+        return false;
+    }
+    if (!push(glyph)) {
+        SDL_DestroySurface(glyph.bitmap.surface);
+        return false;
+    }
+    return true;
+}
+
+bool GlyphUploadQueue::push(StagedGlyph& glyph) {
+    if (!queue_.try_push(std::move(glyph))) {
+        return false;
+    }
+    glyph.bitmap.surface = nullptr;
+    return true;
+}
@@ -0,0 +1,50 @@
+
+#pragma once
+
+#include "bounded_mpsc_queue.hpp"
+#include "glyph_atlas.hpp"
+#include "glyph_raster.hpp"
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <optional>
+
+// A glyph rasterized off the render thread, waiting for
+// GlyphAtlas::drain_uploads(). key names the font the render thread looks
+// the glyph up with, which need not be the face it was rasterized from.
+struct StagedGlyph {
+    GlyphKey key{};
+    GlyphBitmap bitmap;
+};
+
+// Carries glyph bitmaps from worker rasterizers to the render thread
+// through a BoundedMpscQueue, so neither side takes a lock and a burst of
+// glyphs, e.g. prewarming a new language, cannot queue more than capacity
+// bitmaps at once. Any number of threads may stage(); only the render
+// thread pops, normally through GlyphAtlas::drain_uploads().
+class GlyphUploadQueue {
+public:
+    explicit GlyphUploadQueue(std::size_t capacity = 1024);
+    // Destroys the bitmaps nobody drained.
+    ~GlyphUploadQueue();
+
+    GlyphUploadQueue(const GlyphUploadQueue&) = delete;
+    GlyphUploadQueue& operator=(const GlyphUploadQueue&) = delete;
+
+    // Rasterizes codepoint with face, which must not be in use on another
+    // thread (see FontManager::open_exclusive), and queues it for drawing
+    // with font at face's size and hinting in the given render mode.
+    // Returns false if the glyph could not be rasterized or the queue is
+    // full, in which case nothing is queued and the caller may retry once
+    // the render thread has drained some.
+    bool stage(TTF_Font* font, TTF_Font* face, Uint32 codepoint, GlyphRenderMode mode = GlyphRenderMode::blended);
+
+    // Queues an already rasterized glyph, taking its surface on success.
+    bool push(StagedGlyph& glyph);
+
+    std::optional<StagedGlyph> pop() { return queue_.pop(); }
+
+private:
+    BoundedMpscQueue<StagedGlyph> queue_;
+};
@@ -0,0 +1,313 @@
+
+#include "gpu_text.hpp"
+
+#include "text_stats.hpp"
+#include "trace.hpp"
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace {
+
+struct TargetUniforms {
+    float scale[2];
+    float padding[2];
+};
+
+SDL_GPUShader* load_shader(SDL_GPUDevice* device, const char* file, SDL_GPUShaderStage stage, Uint32 samplers, Uint32 uniform_buffers) {
+    const char* base = SDL_GetBasePath();
+    const std::string path = std::string(base != nullptr ? base : "") + "shaders/" + file;
+    std::size_t size = 0;
+    void* code = SDL_LoadFile(path.c_str(), &size);
+    if (code == nullptr) {
+        return nullptr;
+    }
+    SDL_GPUShaderCreateInfo info{};
+    info.code_size = size;
+    info.code = static_cast<const Uint8*>(code);
+    info.entrypoint = "main";
+    info.format = SDL_GPU_SHADERFORMAT_SPIRV;
+    info.stage = stage;
+    info.num_samplers = samplers;
+    info.num_uniform_buffers = uniform_buffers;
+    SDL_GPUShader* shader = SDL_CreateGPUShader(device, &info);
+    SDL_free(code);
+    return shader;
+}
+
+} // namespace
+
+std::unique_ptr<GpuTextRenderer> GpuTextRenderer::create(SDL_GPUDevice* device, SDL_GPUTextureFormat target_format, GlyphAtlas& atlas, ShapedRunCache& runs) {
+    return create(device, target_format, atlas, runs, Config{});
+}
+
+std::unique_ptr<GpuTextRenderer> GpuTextRenderer::create(SDL_GPUDevice* device, SDL_GPUTextureFormat target_format, GlyphAtlas& atlas, ShapedRunCache& runs, Config config) {
+    TRACE_SCOPE("GpuTextRenderer::create");
+    if (atlas.device() != device) {
+        SDL_SetError("GpuTextRenderer: atlas was not created for this device");
+        return nullptr;
+    }
+    config.frames_in_flight = std::max<Uint32>(config.frames_in_flight, 1);
+    config.max_instances = std::max<Uint32>(config.max_instances, 1);
+    std::unique_ptr<GpuTextRenderer> renderer(new GpuTextRenderer(device, atlas, runs, config));
+    if (!renderer->init(target_format)) {
+        return nullptr;
+    }
+    return renderer;
+}
+
+GpuTextRenderer::GpuTextRenderer(SDL_GPUDevice* device, GlyphAtlas& atlas, ShapedRunCache& runs, Config config)
+    : device_(device), atlas_(atlas), runs_(runs), config_(config) {}
+
+GpuTextRenderer::~GpuTextRenderer() {
+    SDL_ReleaseGPUGraphicsPipeline(device_, bitmap_pipeline_);
+    SDL_ReleaseGPUGraphicsPipeline(device_, sdf_pipeline_);
+    SDL_ReleaseGPUSampler(device_, sampler_);
+    SDL_ReleaseGPUBuffer(device_, instance_buffer_);
+    SDL_ReleaseGPUTransferBuffer(device_, instance_transfer_);
+    SDL_ReleaseGPUTransferBuffer(device_, glyph_transfer_);
+}
+
+bool GpuTextRenderer::init(SDL_GPUTextureFormat target_format) {
+    SDL_GPUShader* vertex = load_shader(device_, "text.vert.spv", SDL_GPU_SHADERSTAGE_VERTEX, 0, 1);
+    if (vertex == nullptr) {
+        return false;
+    }
+    bitmap_pipeline_ = create_pipeline(vertex, "text_bitmap.frag.spv", target_format);
+    sdf_pipeline_ = create_pipeline(vertex, "text_sdf.frag.spv", target_format);
+    SDL_ReleaseGPUShader(device_, vertex);
+    if (bitmap_pipeline_ == nullptr || sdf_pipeline_ == nullptr) {
+        return false;
+    }
+
+    SDL_GPUSamplerCreateInfo sampler{};
+    sampler.min_filter = SDL_GPU_FILTER_LINEAR;
+    sampler.mag_filter = SDL_GPU_FILTER_LINEAR;
+    sampler.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST;
+    sampler.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+    sampler.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+    sampler.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+    sampler_ = SDL_CreateGPUSampler(device_, &sampler);
+
+    const Uint32 ring_bytes = slot_bytes() * config_.frames_in_flight;
+    SDL_GPUBufferCreateInfo buffer{};
+    buffer.usage = SDL_GPU_BUFFERUSAGE_VERTEX;
+    buffer.size = ring_bytes;
+    instance_buffer_ = SDL_CreateGPUBuffer(device_, &buffer);
+
+    SDL_GPUTransferBufferCreateInfo transfer{};
+    transfer.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+    transfer.size = ring_bytes;
+    instance_transfer_ = SDL_CreateGPUTransferBuffer(device_, &transfer);
+    return sampler_ != nullptr && instance_buffer_ != nullptr && instance_transfer_ != nullptr;
+}
+
+SDL_GPUGraphicsPipeline* GpuTextRenderer::create_pipeline(SDL_GPUShader* vertex, const char* fragment_file, SDL_GPUTextureFormat target_format) {
+    SDL_GPUShader* fragment = load_shader(device_, fragment_file, SDL_GPU_SHADERSTAGE_FRAGMENT, 1, 0);
+    if (fragment == nullptr) {
+        return nullptr;
+    }
+    const SDL_GPUVertexBufferDescription buffer{0, sizeof(Instance), SDL_GPU_VERTEXINPUTRATE_INSTANCE, 0};
+    const SDL_GPUVertexAttribute attributes[] = {
+        {0, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, offsetof(Instance, rect)},
+        {1, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, offsetof(Instance, uv)},
+        {2, 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, offsetof(Instance, color)},
+    };
+    SDL_GPUColorTargetDescription target{};
+    target.format = target_format;
+    target.blend_state.enable_blend = true;
+    target.blend_state.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
+    target.blend_state.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+    target.blend_state.color_blend_op = SDL_GPU_BLENDOP_ADD;
+    target.blend_state.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+    target.blend_state.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+    target.blend_state.alpha_blend_op = SDL_GPU_BLENDOP_ADD;
+
+    SDL_GPUGraphicsPipelineCreateInfo info{};
+    info.vertex_shader = vertex;
+    info.fragment_shader = fragment;
+    info.vertex_input_state.vertex_buffer_descriptions = &buffer;
+    info.vertex_input_state.num_vertex_buffers = 1;
+    info.vertex_input_state.vertex_attributes = attributes;
+    info.vertex_input_state.num_vertex_attributes = 3;
+    info.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLESTRIP;
+    info.target_info.color_target_descriptions = &target;
+    info.target_info.num_color_targets = 1;
+    SDL_GPUGraphicsPipeline* pipeline = SDL_CreateGPUGraphicsPipeline(device_, &info);
+    SDL_ReleaseGPUShader(device_, fragment);
+    return pipeline;
+}
+
+float GpuTextRenderer::add(TTF_Font* font, std::string_view text, float x, float y, SDL_FColor color) {
+    return add_scaled(font, TTF_GetFontSize(font), text, x, y, color);
+}
+
+float GpuTextRenderer::add_scaled(TTF_Font* font, float size, std::string_view text, float x, float y, SDL_FColor color) {
+    const float scale = size / TTF_GetFontSize(font);
+    const ShapedRun* run = runs_.shape(font, text);
+    if (run == nullptr) {
+        return x;
+    }
+    // Whether the run is SDF and scaled is fixed for all of its glyphs, so
+    // it is decided here rather than per glyph.
+    const bool sdf = TTF_GetFontSDF(font);
+    if (sdf && scale == 1.0f) {
+        add_run<true, false>(font, *run, x, y, color, scale);
+    } else if (sdf) {
+        add_run<true, true>(font, *run, x, y, color, scale);
+    } else if (scale == 1.0f) {
+        add_run<false, false>(font, *run, x, y, color, scale);
+    } else {
+        add_run<false, true>(font, *run, x, y, color, scale);
+    }
+    return x + static_cast<float>(run->width) * scale;
+}
+
+template <bool Sdf, bool Scaled>
+void GpuTextRenderer::add_run(TTF_Font* font, const ShapedRun& run, float x, float y, SDL_FColor color, float scale) {
+    for (const ShapedGlyph& shaped : run.glyphs) {
+        const Glyph* glyph = atlas_.lookup(font, shaped.codepoint);
+        if (glyph == nullptr || glyph->page < 0) {
+            continue;
+        }
+        const std::size_t batch = static_cast<std::size_t>(glyph->page) * 2 + (Sdf ? 1 : 0);
+        if (batches_.size() <= batch) {
+            batches_.resize(batch + 1);
+        }
+        float left = x + shaped.x + static_cast<float>(glyph->offset_x);
+        float top = y + shaped.y + static_cast<float>(glyph->offset_y);
+        float w = static_cast<float>(glyph->rect.w);
+        float h = static_cast<float>(glyph->rect.h);
+        if constexpr (Scaled) {
+            left = x + (shaped.x + static_cast<float>(glyph->offset_x)) * scale;
+            top = y + (shaped.y + static_cast<float>(glyph->offset_y)) * scale;
+            w *= scale;
+            h *= scale;
+        }
+        batches_[batch].instances.push_back(Instance{
+            {left, top, w, h},
+            {glyph->uv.x, glyph->uv.y, glyph->uv.w, glyph->uv.h},
+            {color.r, color.g, color.b, color.a},
+        });
+    }
+}
+
+void GpuTextRenderer::prepare(SDL_GPUCommandBuffer* cmd) {
+    TRACE_SCOPE("GpuTextRenderer::prepare");
+    const bool have_glyphs = !atlas_.pending_uploads().empty();
+    const bool have_instances = instance_count() > 0;
+    if (!have_glyphs && !have_instances) {
+        return;
+    }
+    SDL_GPUCopyPass* copy = SDL_BeginGPUCopyPass(cmd);
+    if (have_glyphs) {
+        upload_glyphs(copy);
+    }
+    if (have_instances) {
+        // The slot written now was last read frames_in_flight frames ago,
+        // so the mapping does not need to cycle.
+        const Uint32 slot_offset = frame_ % config_.frames_in_flight * slot_bytes();
+        auto* mapped = static_cast<Uint8*>(SDL_MapGPUTransferBuffer(device_, instance_transfer_, false));
+        Uint32 written = 0;
+        if (mapped == nullptr) {
+            SDL_Log("GpuTextRenderer: failed to map instances: %s", SDL_GetError());
+        } else {
+            for (Batch& batch : batches_) {
+                batch.first = written;
+                batch.uploaded = std::min<Uint32>(static_cast<Uint32>(batch.instances.size()), config_.max_instances - written);
+                std::memcpy(mapped + slot_offset + written * sizeof(Instance), batch.instances.data(), batch.uploaded * sizeof(Instance));
+                written += batch.uploaded;
+            }
+            SDL_UnmapGPUTransferBuffer(device_, instance_transfer_);
+        }
+        if (written > 0) {
+            const SDL_GPUTransferBufferLocation source{instance_transfer_, slot_offset};
+            const SDL_GPUBufferRegion destination{instance_buffer_, slot_offset, written * static_cast<Uint32>(sizeof(Instance))};
+            SDL_UploadToGPUBuffer(copy, &source, &destination, false);
+        }
+    }
+    SDL_EndGPUCopyPass(copy);
+}
+
+void GpuTextRenderer::upload_glyphs(SDL_GPUCopyPass* copy) {
+    const auto bytes = static_cast<Uint32>(atlas_.pending_bytes());
+    if (glyph_transfer_ == nullptr || glyph_transfer_size_ < bytes) {
+        SDL_ReleaseGPUTransferBuffer(device_, glyph_transfer_);
+        glyph_transfer_size_ = std::max(bytes, glyph_transfer_size_ * 2);
+        SDL_GPUTransferBufferCreateInfo info{};
+        info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+        info.size = glyph_transfer_size_;
+        glyph_transfer_ = SDL_CreateGPUTransferBuffer(device_, &info);
+    }
+    // Glyph uploads are rare after warm-up, so cycling the buffer instead of
+    // ring-slotting it is fine.
+    void* mapped = glyph_transfer_ != nullptr ? SDL_MapGPUTransferBuffer(device_, glyph_transfer_, true) : nullptr;
+    if (mapped == nullptr) {
+        SDL_Log("GpuTextRenderer: failed to stage glyphs: %s", SDL_GetError());
+        return;
+    }
+    std::memcpy(mapped, atlas_.pending_pixels(), bytes);
+    SDL_UnmapGPUTransferBuffer(device_, glyph_transfer_);
+    for (const GlyphAtlas::PendingUpload& upload : atlas_.pending_uploads()) {
+        const SDL_GPUTextureTransferInfo source{glyph_transfer_, static_cast<Uint32>(upload.offset), static_cast<Uint32>(upload.rect.w), static_cast<Uint32>(upload.rect.h)};
+        SDL_GPUTextureRegion destination{};
+        destination.texture = atlas_.gpu_page_texture(upload.page);
+        destination.x = static_cast<Uint32>(upload.rect.x);
+        destination.y = static_cast<Uint32>(upload.rect.y);
+        destination.w = static_cast<Uint32>(upload.rect.w);
+        destination.h = static_cast<Uint32>(upload.rect.h);
+        destination.d = 1;
+        SDL_UploadToGPUTexture(copy, &source, &destination, false);
+    }
+    atlas_.clear_pending_uploads();
+}
+
+int GpuTextRenderer::draw(SDL_GPUCommandBuffer* cmd, SDL_GPURenderPass* pass, float target_w, float target_h) {
+    const TargetUniforms uniforms{{2.0f / target_w, 2.0f / target_h}, {0.0f, 0.0f}};
+    SDL_PushGPUVertexUniformData(cmd, 0, &uniforms, sizeof(uniforms));
+    const Uint32 slot_offset = frame_ % config_.frames_in_flight * slot_bytes();
+    int draws = 0;
+    Uint64 instances = 0;
+    for (std::size_t index = 0; index < batches_.size(); ++index) {
+        Batch& batch = batches_[index];
+        if (batch.uploaded > 0) {
+            SDL_BindGPUGraphicsPipeline(pass, index % 2 == 1 ? sdf_pipeline_ : bitmap_pipeline_);
+            const SDL_GPUBufferBinding binding{instance_buffer_, slot_offset + batch.first * static_cast<Uint32>(sizeof(Instance))};
+            SDL_BindGPUVertexBuffers(pass, 0, &binding, 1);
+            const SDL_GPUTextureSamplerBinding sampler{atlas_.gpu_page_texture(static_cast<int>(index / 2)), sampler_};
+            SDL_BindGPUFragmentSamplers(pass, 0, &sampler, 1);
+            SDL_DrawGPUPrimitives(pass, 4, batch.uploaded, 0, 0);
+            instances += batch.uploaded;
+            ++draws;
+        }
+        batch.instances.clear();
+        batch.uploaded = 0;
+    }
+    text_stats().draw_calls += static_cast<Uint64>(draws);
+    text_stats().vertices += instances * 4;
+    ++frame_;
+    return draws;
+}
+
+void GpuTextRenderer::clear() {
+    for (Batch& batch : batches_) {
+        batch.instances.clear();
+        batch.uploaded = 0;
+    }
+}
+
+std::size_t GpuTextRenderer::instance_count() const {
+    std::size_t instances = 0;
+    for (const Batch& batch : batches_) {
+        instances += batch.instances.size();
+    }
+    return instances;
+}
+
+Uint32 GpuTextRenderer::slot_bytes() const {
+    return config_.max_instances * static_cast<Uint32>(sizeof(Instance));
+}
@@ -0,0 +1,108 @@
+
+#pragma once
+
+#include "glyph_atlas.hpp"
+#include "shaped_run_cache.hpp"
+
+#include <SDL3/SDL_gpu.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Text backend on the SDL3 GPU API. Each glyph is one 48-byte instance
+// (screen rect, atlas rect, color) and every batch is a single instanced
+// draw of a four-vertex strip, so the CPU writes under a third of the bytes
+// per glyph that TextBatch submits, with no index buffer.
+//
+// Instances go through a ring of frames_in_flight slots in one transfer
+// buffer and one vertex buffer, both created up front. Each frame writes
+// the slot the GPU finished with frames_in_flight frames ago, so uploads
+// never wait on the GPU and never reallocate.
+//
+// Glyphs from fonts opened with TTF_SetFontSDF are drawn by a second
+// pipeline whose fragment shader thresholds the distance field with
+// screen-space antialiasing; every other glyph goes through the bitmap
+// pipeline. Shaders are loaded as SPIR-V from shaders/ next to the
+// executable, built from the GLSL sources in the repo.
+//
+// Per frame: add() text, prepare() before the render pass, draw() inside it.
+class GpuTextRenderer {
+public:
+    struct Config {
+        Uint32 frames_in_flight = 3;
+        // Glyphs past this many in one frame are dropped.
+        Uint32 max_instances = 16384;
+    };
+
+    // atlas must have been created for device. Returns nullptr with the SDL
+    // error set if the shaders or GPU resources cannot be created.
+    static std::unique_ptr<GpuTextRenderer> create(SDL_GPUDevice* device, SDL_GPUTextureFormat target_format, GlyphAtlas& atlas, ShapedRunCache& runs);
+    static std::unique_ptr<GpuTextRenderer> create(SDL_GPUDevice* device, SDL_GPUTextureFormat target_format, GlyphAtlas& atlas, ShapedRunCache& runs, Config config);
+    ~GpuTextRenderer();
+
+    GpuTextRenderer(const GpuTextRenderer&) = delete;
+    GpuTextRenderer& operator=(const GpuTextRenderer&) = delete;
+
+    // Queues UTF-8 text with its top-left corner at (x, y). Returns the x
+    // coordinate just past the text's bounding box.
+    float add(TTF_Font* font, std::string_view text, float x, float y, SDL_FColor color);
+
+    // Queues text at size by scaling the glyphs the font has at its own
+    // size; see TextBatch::add_scaled().
+    float add_scaled(TTF_Font* font, float size, std::string_view text, float x, float y, SDL_FColor color);
+
+    // Records a copy pass with the atlas's pending glyph uploads and this
+    // frame's instances. Call outside any render pass.
+    void prepare(SDL_GPUCommandBuffer* cmd);
+
+    // Draws what prepare() uploaded into a render pass on a target_w x
+    // target_h target and clears the queue. Returns the number of draws.
+    int draw(SDL_GPUCommandBuffer* cmd, SDL_GPURenderPass* pass, float target_w, float target_h);
+
+    // Drops everything queued since the last draw, e.g. when no swapchain
+    // image was available this frame.
+    void clear();
+
+    std::size_t instance_count() const;
+
+private:
+    struct Instance {
+        float rect[4];
+        float uv[4];
+        float color[4];
+    };
+
+    struct Batch {
+        std::vector<Instance> instances;
+        Uint32 first = 0;
+        Uint32 uploaded = 0;
+    };
+
+    GpuTextRenderer(SDL_GPUDevice* device, GlyphAtlas& atlas, ShapedRunCache& runs, Config config);
+
+    template <bool Sdf, bool Scaled>
+    void add_run(TTF_Font* font, const ShapedRun& run, float x, float y, SDL_FColor color, float scale);
+
+    bool init(SDL_GPUTextureFormat target_format);
+    SDL_GPUGraphicsPipeline* create_pipeline(SDL_GPUShader* vertex, const char* fragment_file, SDL_GPUTextureFormat target_format);
+    void upload_glyphs(SDL_GPUCopyPass* copy);
+    Uint32 slot_bytes() const;
+
+    SDL_GPUDevice* device_;
+    GlyphAtlas& atlas_;
+    ShapedRunCache& runs_;
+    Config config_;
+    SDL_GPUGraphicsPipeline* bitmap_pipeline_ = nullptr;
+    SDL_GPUGraphicsPipeline* sdf_pipeline_ = nullptr;
+    SDL_GPUSampler* sampler_ = nullptr;
+    SDL_GPUBuffer* instance_buffer_ = nullptr;
+    SDL_GPUTransferBuffer* instance_transfer_ = nullptr;
+    SDL_GPUTransferBuffer* glyph_transfer_ = nullptr;
+    Uint32 glyph_transfer_size_ = 0;
+    // Indexed by page * 2 + (sdf ? 1 : 0).
+    std::vector<Batch> batches_;
+    Uint32 frame_ = 0;
+};
@@ -0,0 +1,69 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Heights of a long list of rows (paragraphs, lines) kept in a Fenwick
+// tree, so the offset of any row and the row at any offset are found in
+// O(log n) and changing one height does not touch the rows after it.
+// Heights must not be negative.
+class HeightIndex {
+public:
+    std::size_t size() const { return heights_.size(); }
+    std::int64_t total() const { return prefix(heights_.size()); }
+    int height(std::size_t row) const { return heights_[row]; }
+
+    void clear() {
+        heights_.clear();
+        tree_.clear();
+    }
+
+    void push_back(int height) {
+        heights_.push_back(height);
+        // Node i covers the lowbit(i) rows ending at i; everything but the new
+        // row is already summed in the tree.
+        const std::size_t i = heights_.size();
+        tree_.push_back(height + prefix(i - 1) - prefix(i - (i & (~i + 1))));
+    }
+
+    void set(std::size_t row, int height) {
+        const std::int64_t delta = height - heights_[row];
+        heights_[row] = height;
+        for (std::size_t i = row + 1; i <= tree_.size(); i += i & (~i + 1)) {
+            tree_[i - 1] += delta;
+        }
+    }
+
+    // Sum of the heights of the first `rows` rows, i.e. the offset of row
+    // `rows`.
+    std::int64_t prefix(std::size_t rows) const {
+        std::int64_t sum = 0;
+        for (std::size_t i = rows; i > 0; i -= i & (~i + 1)) {
+            sum += tree_[i - 1];
+        }
+        return sum;
+    }
+
+    // The row containing offset, or size() if offset is past the end.
+    // Offsets before the first row map to row 0.
+    std::size_t find(std::int64_t offset) const {
+        std::size_t row = 0;
+        std::size_t step = 1;
+        while (step * 2 <= tree_.size()) {
+            step *= 2;
+        }
+        for (; step > 0; step /= 2) {
+            if (row + step <= tree_.size() && tree_[row + step - 1] <= offset) {
+                row += step;
+                offset -= tree_[row - 1];
+            }
+        }
+        return row;
+    }
+
+private:
+    std::vector<int> heights_;
+    std::vector<std::int64_t> tree_;
+};
@@ -0,0 +1,109 @@
+
+#include "line_index.hpp"
+
+#include "trace.hpp"
+
+#include <SDL3/SDL_events.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t scan_chunk = 1024 * 1024;
+
+} // namespace
+
+LineIndex::LineIndex(std::shared_ptr<const MappedFile> file)
+    : LineIndex(std::move(file), Config{}) {}
+
+LineIndex::LineIndex(std::shared_ptr<const MappedFile> file, Config config)
+    : file_(std::move(file)), data_(static_cast<const char*>(file_->data())), size_(file_->size()), config_(config) {
+    config_.stride = std::max<std::size_t>(config_.stride, 1);
+    checkpoints_.push_back(0);
+    worker_ = std::thread([this] { run(); });
+}
+
+LineIndex::~LineIndex() {
+    stopping_.store(true, std::memory_order_relaxed);
+    worker_.join();
+}
+
+float LineIndex::progress() const {
+    return size_ == 0 ? 1.0f : static_cast<float>(static_cast<double>(scanned_.load(std::memory_order_relaxed)) / static_cast<double>(size_));
+}
+
+std::string_view LineIndex::line(std::size_t index) const {
+    std::size_t offset = line_start(index);
+    return line_at(offset);
+}
+
+void LineIndex::run() {
+    TRACE_SCOPE("LineIndex::run");
+    std::size_t lines = 0;
+    std::size_t next_wake = config_.wake_bytes;
+    const auto wake = [this] {
+        if (config_.wake_event != 0) {
+            SDL_Event event{};
+            event.type = config_.wake_event;
+            SDL_PushEvent(&event);
+        }
+    };
+    for (std::size_t pos = 0; pos < size_ && !stopping_.load(std::memory_order_relaxed);) {
+        const std::size_t end = std::min(pos + scan_chunk, size_);
+        while (pos < end) {
+            const auto* newline = static_cast<const char*>(std::memchr(data_ + pos, '\n', end - pos));
+            if (newline == nullptr) {
+                pos = end;
+                break;
+            }
+            pos = static_cast<std::size_t>(newline - data_) + 1;
+            ++lines;
+            if (lines % config_.stride == 0 && pos < size_) {
+                std::lock_guard lock(mutex_);
+                checkpoints_.push_back(pos);
+            }
+        }
+        // Publish per chunk: the checkpoints for these lines are already in.
+        lines_.store(lines, std::memory_order_release);
+        scanned_.store(pos, std::memory_order_relaxed);
+        if (pos >= next_wake) {
+            next_wake = pos + config_.wake_bytes;
+            wake();
+        }
+    }
+    if (stopping_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // A last line without a newline still counts.
+    if (size_ > 0 && data_[size_ - 1] != '\n') {
+        lines_.store(lines + 1, std::memory_order_release);
+    }
+    complete_.store(true, std::memory_order_release);
+    wake();
+}
+
+std::size_t LineIndex::line_start(std::size_t index) const {
+    std::size_t offset = 0;
+    {
+        std::lock_guard lock(mutex_);
+        offset = checkpoints_[index / config_.stride];
+    }
+    for (std::size_t skip = index % config_.stride; skip > 0; --skip) {
+        const auto* newline = static_cast<const char*>(std::memchr(data_ + offset, '\n', size_ - offset));
+        offset = static_cast<std::size_t>(newline - data_) + 1;
+    }
+    return offset;
+}
+
+// Returns the line starting at offset and moves offset to the next one.
+std::string_view LineIndex::line_at(std::size_t& offset) const {
+    const auto* newline = static_cast<const char*>(std::memchr(data_ + offset, '\n', size_ - offset));
+    const std::size_t end = newline != nullptr ? static_cast<std::size_t>(newline - data_) : size_;
+    std::string_view line(data_ + offset, end - offset);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    offset = std::min(end + 1, size_);
+    return line;
+}
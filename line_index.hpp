@@ -0,0 +1,94 @@
+
+#pragma once
+
+#include "mapped_file.hpp"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Finds the lines of a memory-mapped UTF-8 file on a background thread, so
+// a viewer can show the start of a multi-gigabyte log while the rest is
+// still being scanned.
+//
+// Only every stride-th line's byte offset is kept; a line in between is
+// found by scanning forward from the checkpoint before it. At the default
+// stride a file of 100 million lines costs about 3 MB of index. The file
+// is read through the mapping, so its pages stay in the page cache, where
+// the kernel can reclaim them, rather than in process memory.
+//
+// Lines end at '\n' and a trailing '\r' is dropped. Everything may be
+// called from any thread while the scan runs.
+class LineIndex {
+public:
+    struct Config {
+        std::size_t stride = 256;
+        // When non-zero, an SDL event of this type (see SDL_RegisterEvents)
+        // is pushed every wake_bytes of progress and when the scan ends, so
+        // a loop blocked in SDL_WaitEvent can update its scroll range.
+        Uint32 wake_event = 0;
+        std::size_t wake_bytes = 16 * 1024 * 1024;
+    };
+
+    explicit LineIndex(std::shared_ptr<const MappedFile> file);
+    LineIndex(std::shared_ptr<const MappedFile> file, Config config);
+    ~LineIndex();
+
+    LineIndex(const LineIndex&) = delete;
+    LineIndex& operator=(const LineIndex&) = delete;
+
+    // Lines found so far; the total once complete().
+    std::size_t line_count() const { return lines_.load(std::memory_order_acquire); }
+    bool complete() const { return complete_.load(std::memory_order_acquire); }
+
+    // Fraction of the file scanned, from 0 to 1.
+    float progress() const;
+
+    // Returns line index, which must be below line_count(). Views point into
+    // the mapping and stay valid for the index's lifetime.
+    std::string_view line(std::size_t index) const;
+
+    // Replaces out with up to count lines starting at first, cheaper than
+    // count calls to line() since only the first is searched for. out may
+    // use any allocator, e.g. a ScratchVector.
+    template <typename Allocator>
+    void lines(std::size_t first, std::size_t count, std::vector<std::string_view, Allocator>& out) const {
+        out.clear();
+        const std::size_t available = line_count();
+        if (first >= available) {
+            return;
+        }
+        count = std::min(count, available - first);
+        out.reserve(count);
+        std::size_t offset = line_start(first);
+        for (std::size_t i = 0; i < count; ++i) {
+            out.push_back(line_at(offset));
+        }
+    }
+
+private:
+    void run();
+    std::size_t line_start(std::size_t index) const;
+    std::string_view line_at(std::size_t& offset) const;
+
+    std::shared_ptr<const MappedFile> file_;
+    const char* data_;
+    std::size_t size_;
+    Config config_;
+    mutable std::mutex mutex_;
+    // checkpoints_[k] is the byte offset of line k * stride.
+    std::vector<std::uint64_t> checkpoints_;
+    std::atomic<std::size_t> lines_{0};
+    std::atomic<std::size_t> scanned_{0};
+    std::atomic<bool> complete_{false};
+    std::atomic<bool> stopping_{false};
+    std::thread worker_;
+};
@@ -1,14 +1,661 @@
 
-#include <SDL3/SDL_init.h>
+#include "atlas_file.hpp"
+#include "damage_tracker.hpp"
+#include "document_view.hpp"
+#include "executor.hpp"
+#include "font_loader.hpp"
+#include "font_manager.hpp"
+#include "glyph_atlas.hpp"
+#include "gpu_text.hpp"
+#include "line_index.hpp"
+#include "mapped_file.hpp"
+#include "memory_budget.hpp"
+#include "quality_tiers.hpp"
+#include "sdl_allocator.hpp"
+#include "shaped_run_cache.hpp"
+#include "subsystems.hpp"
+#include "surface_text.hpp"
+#include "text_batch.hpp"
+#include "text_stats.hpp"
+#include "trace.hpp"
+
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_keycode.h>
+#include <SDL3/SDL_main.h>
+#include <SDL3/SDL_render.h>
+#include <SDL3/SDL_surface.h>
+#include <SDL3/SDL_timer.h>
 #include <SDL3_ttf/SDL_ttf.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Options {
+    const char* font_path = nullptr;
+    // Skips the video subsystem and renders into a surface instead of a
+    // window. Also enabled by a non-zero EXAMPLE_HEADLESS.
+    bool headless = false;
+    // Headless only: where to write the rendered frame as a BMP.
+    const char* output = nullptr;
+    // Headless and --gpu only: also draws the sample at several sizes from
+    // one signed-distance-field face rasterized at sdf_reference_size.
+    bool sdf = false;
+    // Window only: an atlas baked by atlas_tool to warm the glyph atlas
+    // from instead of rasterizing on a worker.
+    const char* atlas = nullptr;
+    // Window only: draws the text pipeline counters of the last redraw.
+    bool stats = false;
+    // Window only: draws through GpuTextRenderer on SDL_GPU instead of
+    // TextBatch on SDL_Renderer.
+    bool gpu = false;
+    // Window only: scrolls through this UTF-8 file instead of the demo.
+    const char* view = nullptr;
+    // Window only: the best text quality tier, which the demo drops below
+    // while redraws run over budget.
+    const char* quality = "normal";
+};
+
+constexpr float sdf_reference_size = 32.0f;
+constexpr float sdf_sizes[] = {12.0f, 18.0f, 32.0f, 64.0f};
+
+Options parse_options(int argc, char* argv[]) {
+    Options options;
+    const char* env = std::getenv("EXAMPLE_HEADLESS");
+    options.headless = env != nullptr && *env != '\0' && std::strcmp(env, "0") != 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            options.headless = true;
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (std::strcmp(argv[i], "--atlas") == 0 && i + 1 < argc) {
+            options.atlas = argv[++i];
+        } else if (std::strcmp(argv[i], "--view") == 0 && i + 1 < argc) {
+            options.view = argv[++i];
+        } else if (std::strcmp(argv[i], "--quality") == 0 && i + 1 < argc) {
+            options.quality = argv[++i];
+        } else if (std::strcmp(argv[i], "--gpu") == 0) {
+            options.gpu = true;
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            options.stats = true;
+        } else if (std::strcmp(argv[i], "--sdf") == 0) {
+            options.sdf = true;
+        } else {
+            options.font_path = argv[i];
+        }
+    }
+    if (options.sdf && !options.headless && !options.gpu) {
+        // TextBatch cannot threshold the field, so it would draw soft halos.
+        std::cout<<"--sdf needs --headless or --gpu, ignoring it"<<std::endl;
+        options.sdf = false;
+    }
+    return options;
+}
+
+// Batch is TextBatch or GpuTextRenderer.
+template <typename Batch>
+void draw_sample(Batch& batch, TTF_Font* font) {
+    batch.add(font, "hello SDL ttf", 16.0f, 16.0f, SDL_FColor{1.0f, 1.0f, 1.0f, 1.0f});
+    batch.add(font, "glyphs are rasterized once and batched per atlas page", 16.0f, 48.0f, SDL_FColor{0.6f, 0.8f, 1.0f, 1.0f});
+}
+
+template <typename Batch>
+void draw_sdf_sample(Batch& batch, TTF_Font* font) {
+    float y = 96.0f;
+    for (const float size : sdf_sizes) {
+        batch.add_scaled(font, size, "one field, every size", 16.0f, y, SDL_FColor{1.0f, 0.9f, 0.6f, 1.0f});
+        y += size * 1.25f;
+    }
+}
+
+// Renders one frame on the CPU into a memory surface and optionally saves
+// it, without touching the video subsystem.
+bool run_headless(Subsystems& subsystems, FontManager& fonts, const Options& options) {
+    if (!subsystems.ttf()) {
+        std::cout<<"failed to initialize SDL_ttf: "<<SDL_GetError()<<std::endl;
+        return false;
+    }
+    const FontHandle font = fonts.open(options.font_path, 24.0f);
+    if (!font) {
+        std::cout<<"failed to open "<<options.font_path<<": "<<SDL_GetError()<<std::endl;
+        return false;
+    }
+    SDL_Surface* surface = SDL_CreateSurface(800, 600, SDL_PIXELFORMAT_ARGB8888);
+    if (surface == nullptr) {
+        std::cout<<"failed to create surface: "<<SDL_GetError()<<std::endl;
+        return false;
+    }
+    bool ok = true;
+    {
+        ShapedRunCache runs;
+        SurfaceTextRenderer text(runs);
+        SDL_FillSurfaceRect(surface, nullptr, SDL_MapSurfaceRGBA(surface, 16, 16, 24, 255));
+        {
+            TRACE_SCOPE("draw_sample");
+            text.draw(surface, font.get(), "hello SDL ttf", 16, 16, SDL_Color{255, 255, 255, 255});
+            trace_instant("first_glyph");
+            text.draw(surface, font.get(), "glyphs are blended into the surface on the CPU", 16, 48, SDL_Color{153, 204, 255, 255});
+        }
+        if (options.sdf) {
+            TRACE_SCOPE("draw_sdf_sample");
+            const FontHandle sdf = fonts.open_sdf(options.font_path, sdf_reference_size);
+            float y = 96.0f;
+            for (const float size : sdf_sizes) {
+                if (sdf) {
+                    text.draw_scaled(surface, sdf.get(), size, "one field, every size", 16.0f, y, SDL_Color{255, 230, 153, 255});
+                }
+                y += size * 1.25f;
+            }
+        }
+        trace_instant("first_present");
+        if (options.output != nullptr && !SDL_SaveBMP(surface, options.output)) {
+            std::cout<<"failed to write "<<options.output<<": "<<SDL_GetError()<<std::endl;
+            ok = false;
+        }
+    }
+    SDL_DestroySurface(surface);
+    return ok;
+}
+
+// The fonts run_demo draws with, filled in by load_demo_fonts() as each one
+// becomes usable.
+struct DemoFonts {
+    FontHandle font;
+    bool failed = false;
+};
+
+// Loads the demo's fonts as a chain of steps: files are opened and glyphs
+// rasterized on executor workers, and atlas uploads happen back on the
+// render thread, which marks the scene damaged after each font so it is
+// drawn as soon as it arrives.
+//
+// With --atlas the glyphs come from the baked file instead and nothing is
+// rasterized; if the file has no glyphs for the demo font the ASCII range
+// is rasterized as usual.
+Task<void> load_demo_fonts(Executor& executor, Subsystems& subsystems, FontManager& fonts, GlyphAtlas& atlas, DamageTracker& damage, const Options& options, DemoFonts& out) {
+    constexpr float size = 24.0f;
+    // TTF_Init may still be running; wait for it here rather than on the
+    // render thread.
+    co_await executor.on_worker();
+    if (!subsystems.ttf()) {
+        co_await executor.on_render();
+        std::cout<<"failed to initialize SDL_ttf"<<std::endl;
+        out.failed = true;
+        co_return;
+    }
+    if (options.atlas != nullptr) {
+        const std::shared_ptr<AtlasFile> baked = AtlasFile::open(options.atlas);
+        int index = -1;
+        FontHandle font;
+        if (baked == nullptr) {
+            std::cout<<"failed to open "<<options.atlas<<": "<<SDL_GetError()<<std::endl;
+        } else {
+            const std::string_view path = options.font_path;
+            const std::size_t slash = path.find_last_of("/\\");
+            index = baked->find_font(slash == std::string_view::npos ? path : path.substr(slash + 1), size);
+            if (index < 0) {
+                std::cout<<options.atlas<<" has no glyphs for "<<options.font_path<<std::endl;
+            } else {
+                font = fonts.open(options.font_path, size);
+            }
+        }
+        co_await executor.on_render();
+        if (font && adopt_atlas_file(atlas, *baked, static_cast<std::size_t>(index), font.get())) {
+            out.font = std::move(font);
+            damage.add_all();
+        } else if (font) {
+            std::cout<<"failed to adopt "<<options.atlas<<": "<<SDL_GetError()<<std::endl;
+        }
+    }
+    if (!out.font) {
+        // Without --atlas this is still the worker that waited for TTF_Init.
+        if (options.atlas != nullptr) {
+            co_await executor.on_worker();
+        }
+        // Exclusive, since this thread rasterizes with it while the render
+        // thread may be drawing with the shared face.
+        LoadedFont loaded;
+        loaded.path = options.font_path;
+        loaded.size = size;
+        loaded.font = fonts.open_exclusive(loaded.path, size);
+        if (loaded.font) {
+            TRACE_SCOPE("build_atlas_pages");
+            loaded.pages = build_atlas_pages(loaded.font.get(), {CodepointRange{0x20, 0x7E}}, atlas.config().page_size, atlas.config().padding);
+        } else {
+            loaded.error = SDL_GetError();
+        }
+        co_await executor.on_render();
+        out.font = adopt_loaded_font(atlas, loaded);
+        if (!out.font) {
+            out.failed = true;
+            co_return;
+        }
+        damage.add_all();
+    }
+}
+
+// Creates the texture the demo keeps its scene in, matching the renderer's
+// output size.
+SDL_Texture* create_scene_texture(SDL_Renderer* renderer, DamageTracker& damage) {
+    int w = 0;
+    int h = 0;
+    SDL_GetRenderOutputSize(renderer, &w, &h);
+    SDL_Texture* scene = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+    if (scene == nullptr) {
+        std::cout<<"failed to create scene texture: "<<SDL_GetError()<<std::endl;
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(scene, SDL_BLENDMODE_NONE);
+    damage.resize(w, h);
+    return scene;
+}
+
+// Draws a few lines through the glyph atlas until the window is closed. The
+// fonts are loaded by load_demo_fonts() on an Executor, so the window comes
+// up and presents its first frame straight away.
+//
+// The loop is event driven: it sleeps in SDL_WaitEvent until something
+// happens, and only repaints what was damaged. The scene lives in a target
+// texture, so an expose just presents it again, and a redraw clips to the
+// damaged area instead of clearing the whole window.
+void run_demo(Subsystems& subsystems, FontManager& fonts, const Options& options) {
+    SDL_Window* window = nullptr;
+    SDL_Renderer* renderer = nullptr;
+    if (!subsystems.video()) {
+        std::cout<<"failed to initialize video: "<<SDL_GetError()<<std::endl;
+        return;
+    }
+    {
+        TRACE_SCOPE("SDL_CreateWindowAndRenderer");
+        if (!SDL_CreateWindowAndRenderer("hello SDL ttf", 800, 600, SDL_WINDOW_RESIZABLE, &window, &renderer)) {
+            std::cout<<"failed to create window: "<<SDL_GetError()<<std::endl;
+            return;
+        }
+    }
+    SDL_SetRenderVSync(renderer, 1);
+    {
+        GlyphAtlas atlas(renderer);
+        ShapedRunCache runs;
+        MemoryBudget budget;
+        budget.add("atlas", atlas, 4.0f);
+        budget.add("runs", runs);
+        TextBatch batch(atlas, runs);
+        QualityController quality(atlas);
+        // Shared faces close when their last handle goes, which callers
+        // cannot see; drop their glyphs and runs before the address can be
+        // reused.
+        const FontManager::CloseListener forget_fonts = fonts.on_close([&](TTF_Font* font) {
+            atlas.forget(font);
+            runs.forget(font);
+            quality.remove_font(font);
+        });
+        const std::vector<QualityTier> tiers = default_quality_tiers();
+        const auto tier = std::find_if(tiers.begin(), tiers.end(), [&](const QualityTier& t) { return std::strcmp(t.name, options.quality) == 0; });
+        if (tier == tiers.end()) {
+            std::cout<<"unknown quality tier "<<options.quality<<", using normal"<<std::endl;
+        }
+        quality.set_tier(tier == tiers.end() ? 1 : static_cast<std::size_t>(tier - tiers.begin()));
+        DamageTracker damage;
+        DemoFonts demo;
+        // Declared last so its destructor finishes the loads while
+        // everything they touch is still alive.
+        Executor::Config executor_config;
+        executor_config.wake_event = SDL_RegisterEvents(1);
+        Executor executor(executor_config);
+        executor.spawn(load_demo_fonts(executor, subsystems, fonts, atlas, damage, options, demo));
+
+        SDL_Texture* scene = nullptr;
+        TextStats last_redraw;
+        bool needs_present = true;
+        bool first_present = true;
+        bool first_glyph = true;
+        bool running = true;
+        while (running) {
+            SDL_Event event;
+            const bool idle = scene != nullptr && damage.empty() && !needs_present;
+            bool have_event = idle ? SDL_WaitEvent(&event) : SDL_PollEvent(&event);
+            for (; have_event; have_event = SDL_PollEvent(&event)) {
+                switch (event.type) {
+                case SDL_EVENT_QUIT:
+                    running = false;
+                    break;
+                case SDL_EVENT_WINDOW_EXPOSED:
+                    needs_present = true;
+                    break;
+                case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                    SDL_DestroyTexture(scene);
+                    scene = nullptr;
+                    break;
+                case SDL_EVENT_RENDER_TARGETS_RESET:
+                    damage.add_all();
+                    break;
+                case SDL_EVENT_LOW_MEMORY:
+                    budget.handle_event(event);
+                    break;
+                default:
+                    break;
+                }
+            }
+            executor.run_pending();
+            if (demo.failed) {
+                running = false;
+            }
+            if (scene == nullptr && (scene = create_scene_texture(renderer, damage)) == nullptr) {
+                break;
+            }
+            if (!damage.empty()) {
+                TRACE_SCOPE("redraw");
+                const Uint64 redraw_start = SDL_GetPerformanceCounter();
+                quality.add_font(demo.font.get());
+                atlas.begin_frame();
+                atlas.defragment();
+                const SDL_Rect clip = damage.bounds();
+                const SDL_FRect area{static_cast<float>(clip.x), static_cast<float>(clip.y), static_cast<float>(clip.w), static_cast<float>(clip.h)};
+                SDL_SetRenderTarget(renderer, scene);
+                SDL_SetRenderClipRect(renderer, &clip);
+                SDL_SetRenderDrawColor(renderer, 16, 16, 24, 255);
+                SDL_RenderFillRect(renderer, &area);
+                if (demo.font) {
+                    draw_sample(batch, demo.font.get());
+                    if (first_glyph && batch.quad_count() > 0) {
+                        trace_instant("first_glyph");
+                        first_glyph = false;
+                    }
+                    batch.flush();
+                }
+                SDL_SetRenderClipRect(renderer, nullptr);
+                SDL_SetRenderTarget(renderer, nullptr);
+                damage.clear();
+                needs_present = true;
+                last_redraw = end_stats_frame();
+                const double redraw_ms = static_cast<double>(SDL_GetPerformanceCounter() - redraw_start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+                if (quality.end_frame(redraw_ms)) {
+                    damage.add_all();
+                }
+            }
+            if (needs_present) {
+                SDL_RenderTexture(renderer, scene, nullptr, nullptr);
+                if (options.stats) {
+                    int output_w = 0;
+                    int output_h = 0;
+                    SDL_GetRenderOutputSize(renderer, &output_w, &output_h);
+                    draw_stats_overlay(renderer, last_redraw, atlas, runs, 8.0f, static_cast<float>(output_h) - 80.0f);
+                }
+                if (first_present) {
+                    TRACE_SCOPE("first_present");
+                    SDL_RenderPresent(renderer);
+                    trace_instant("first_present");
+                    first_present = false;
+                } else {
+                    SDL_RenderPresent(renderer);
+                }
+                needs_present = false;
+            }
+        }
+        SDL_DestroyTexture(scene);
+    }
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+}
+
+// Scrolls through options.view with a DocumentView. The file is mapped and
+// its lines indexed in the background, so the first screen shows at once
+// and the scroll range grows as the scan proceeds.
+void run_viewer(Subsystems& subsystems, FontManager& fonts, const Options& options) {
+    const std::shared_ptr<MappedFile> file = MappedFile::open(options.view);
+    if (file == nullptr) {
+        std::cout<<"failed to open "<<options.view<<": "<<SDL_GetError()<<std::endl;
+        return;
+    }
+    if (!subsystems.video()) {
+        std::cout<<"failed to initialize video: "<<SDL_GetError()<<std::endl;
+        return;
+    }
+    SDL_Window* window = nullptr;
+    SDL_Renderer* renderer = nullptr;
+    if (!SDL_CreateWindowAndRenderer(options.view, 1024, 768, SDL_WINDOW_RESIZABLE, &window, &renderer)) {
+        std::cout<<"failed to create window: "<<SDL_GetError()<<std::endl;
+        return;
+    }
+    const FontHandle font = subsystems.ttf() ? fonts.open(options.font_path, 16.0f) : FontHandle();
+    if (!font) {
+        std::cout<<"failed to open "<<options.font_path<<": "<<SDL_GetError()<<std::endl;
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        return;
+    }
+    SDL_SetRenderVSync(renderer, 1);
+    TTF_TextEngine* engine = TTF_CreateRendererTextEngine(renderer);
+    if (engine == nullptr) {
+        std::cout<<"failed to create text engine: "<<SDL_GetError()<<std::endl;
+    } else {
+        LineIndex::Config index_config;
+        index_config.wake_event = SDL_RegisterEvents(1);
+        LineIndex index(file, index_config);
+        DocumentView view(engine, font.get(), index);
+        const float status_h = 16.0f;
+        // A double, since float pixels stop resolving single lines about a
+        // million lines in.
+        double scroll_y = 0.0;
+        bool dirty = true;
+        bool running = true;
+        while (running) {
+            SDL_Event event;
+            bool have_event = dirty ? SDL_PollEvent(&event) : SDL_WaitEvent(&event);
+            int output_w = 0;
+            int output_h = 0;
+            SDL_GetRenderOutputSize(renderer, &output_w, &output_h);
+            const float page = std::max(static_cast<float>(output_h) - status_h, 0.0f);
+            const auto line = static_cast<double>(view.line_height());
+            for (; have_event; have_event = SDL_PollEvent(&event)) {
+                switch (event.type) {
+                case SDL_EVENT_QUIT:
+                    running = false;
+                    break;
+                case SDL_EVENT_MOUSE_WHEEL:
+                    scroll_y -= static_cast<double>(event.wheel.y) * 3.0 * line;
+                    break;
+                case SDL_EVENT_KEY_DOWN:
+                    switch (event.key.key) {
+                    case SDLK_UP:
+                        scroll_y -= line;
+                        break;
+                    case SDLK_DOWN:
+                        scroll_y += line;
+                        break;
+                    case SDLK_PAGEUP:
+                        scroll_y -= page;
+                        break;
+                    case SDLK_PAGEDOWN:
+                        scroll_y += page;
+                        break;
+                    case SDLK_HOME:
+                        scroll_y = 0.0;
+                        break;
+                    case SDLK_END:
+                        scroll_y = static_cast<double>(view.content_height());
+                        break;
+                    case SDLK_ESCAPE:
+                        running = false;
+                        break;
+                    default:
+                        break;
+                    }
+                    break;
+                default:
+                    break;
+                }
+                // Index progress, exposes and resizes all redraw as well.
+                dirty = true;
+            }
+            if (!dirty || !running) {
+                continue;
+            }
+            TRACE_SCOPE("redraw");
+            const double max_scroll = std::max(static_cast<double>(view.content_height()) - page, 0.0);
+            scroll_y = std::clamp(scroll_y, 0.0, max_scroll);
+            SDL_SetRenderDrawColor(renderer, 16, 16, 24, 255);
+            SDL_RenderClear(renderer);
+            view.draw_renderer(8.0f, 0.0f, scroll_y, page);
+            char status[128];
+            const std::size_t top_line = static_cast<std::size_t>(scroll_y / line) + 1;
+            if (index.complete()) {
+                std::snprintf(status, sizeof(status), "line %zu of %zu", top_line, index.line_count());
+            } else {
+                std::snprintf(status, sizeof(status), "line %zu of %zu, indexing %d%%", top_line, index.line_count(), static_cast<int>(index.progress() * 100.0f));
+            }
+            SDL_SetRenderDrawColor(renderer, 160, 160, 176, 255);
+            SDL_RenderDebugText(renderer, 8.0f, page + 4.0f, status);
+            SDL_RenderPresent(renderer);
+            dirty = false;
+        }
+    }
+    if (engine != nullptr) {
+        TTF_DestroyRendererTextEngine(engine);
+    }
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+}
+
+// The demo scene on SDL_GPU. Like run_demo it only draws when an event
+// asks for it, but always the whole frame, since swapchain images are not
+// preserved between presents.
+void run_gpu_demo(Subsystems& subsystems, FontManager& fonts, const Options& options) {
+    if (!subsystems.video()) {
+        std::cout<<"failed to initialize video: "<<SDL_GetError()<<std::endl;
+        return;
+    }
+    SDL_GPUDevice* device = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV, false, nullptr);
+    if (device == nullptr) {
+        std::cout<<"failed to create GPU device: "<<SDL_GetError()<<std::endl;
+        return;
+    }
+    SDL_Window* window = SDL_CreateWindow("hello SDL ttf", 800, 600, SDL_WINDOW_RESIZABLE);
+    if (window == nullptr || !SDL_ClaimWindowForGPUDevice(device, window)) {
+        std::cout<<"failed to create window: "<<SDL_GetError()<<std::endl;
+        SDL_DestroyWindow(window);
+        SDL_DestroyGPUDevice(device);
+        return;
+    }
+    {
+        GlyphAtlas atlas(device, GlyphAtlas::Config{});
+        ShapedRunCache runs;
+        const FontManager::CloseListener forget_fonts = fonts.on_close([&](TTF_Font* font) {
+            atlas.forget(font);
+            runs.forget(font);
+        });
+        const std::unique_ptr<GpuTextRenderer> text = GpuTextRenderer::create(device, SDL_GetGPUSwapchainTextureFormat(device, window), atlas, runs);
+        if (text == nullptr) {
+            std::cout<<"failed to set up GPU text: "<<SDL_GetError()<<std::endl;
+        } else if (!subsystems.ttf()) {
+            std::cout<<"failed to initialize SDL_ttf"<<std::endl;
+        } else {
+            FontHandle font;
+            FontLoader::Config loader_config;
+            loader_config.page_size = atlas.config().page_size;
+            loader_config.padding = atlas.config().padding;
+            loader_config.wake_event = SDL_RegisterEvents(1);
+            FontLoader loader(fonts, loader_config);
+            loader.request(options.font_path, 24.0f, {CodepointRange{0x20, 0x7E}});
+            const FontHandle sdf = options.sdf ? fonts.open_sdf(options.font_path, sdf_reference_size) : FontHandle();
+
+            bool dirty = true;
+            bool running = true;
+            while (running) {
+                SDL_Event event;
+                bool have_event = dirty ? SDL_PollEvent(&event) : SDL_WaitEvent(&event);
+                for (; have_event; have_event = SDL_PollEvent(&event)) {
+                    if (event.type == SDL_EVENT_QUIT) {
+                        running = false;
+                    } else if (event.type == SDL_EVENT_WINDOW_EXPOSED || event.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED) {
+                        dirty = true;
+                    }
+                }
+                while (auto loaded = loader.poll()) {
+                    if (FontHandle opened = adopt_loaded_font(atlas, *loaded)) {
+                        font = std::move(opened);
+                        dirty = true;
+                    } else {
+                        running = false;
+                    }
+                }
+                if (!dirty || !running) {
+                    continue;
+                }
+                TRACE_SCOPE("redraw");
+                atlas.begin_frame();
+                atlas.defragment();
+                if (font) {
+                    draw_sample(*text, font.get());
+                    if (sdf) {
+                        draw_sdf_sample(*text, sdf.get());
+                    }
+                }
+                SDL_GPUCommandBuffer* cmd = SDL_AcquireGPUCommandBuffer(device);
+                if (cmd == nullptr) {
+                    text->clear();
+                    continue;
+                }
+                text->prepare(cmd);
+                SDL_GPUTexture* swapchain = nullptr;
+                Uint32 w = 0;
+                Uint32 h = 0;
+                if (SDL_WaitAndAcquireGPUSwapchainTexture(cmd, window, &swapchain, &w, &h) && swapchain != nullptr) {
+                    SDL_GPUColorTargetInfo target{};
+                    target.texture = swapchain;
+                    target.clear_color = SDL_FColor{16.0f / 255.0f, 16.0f / 255.0f, 24.0f / 255.0f, 1.0f};
+                    target.load_op = SDL_GPU_LOADOP_CLEAR;
+                    target.store_op = SDL_GPU_STOREOP_STORE;
+                    SDL_GPURenderPass* pass = SDL_BeginGPURenderPass(cmd, &target, 1, nullptr);
+                    text->draw(cmd, pass, static_cast<float>(w), static_cast<float>(h));
+                    SDL_EndGPURenderPass(pass);
+                    dirty = false;
+                } else {
+                    text->clear();
+                }
+                SDL_SubmitGPUCommandBuffer(cmd);
+            }
+            SDL_WaitForGPUIdle(device);
+        }
+    }
+    SDL_ReleaseWindowFromGPUDevice(device, window);
+    SDL_DestroyWindow(window);
+    SDL_DestroyGPUDevice(device);
+}
+
+} // namespace
 
-int main() {
-    SDL_Init(SDL_INIT_VIDEO);
-    TTF_Init();
-    TTF_Quit();
-    SDL_Quit();
+int main(int argc, char* argv[]) {
+    install_sdl_allocator();
+    trace_init();
+    int status = 0;
+    {
+        // Starts TTF_Init in the background before anything else.
+        Subsystems subsystems;
+        const Options options = parse_options(argc, argv);
+        if (options.font_path != nullptr) {
+            FontManager fonts;
+            if (options.headless) {
+                status = run_headless(subsystems, fonts, options) ? 0 : 1;
+            } else if (options.view != nullptr) {
+                run_viewer(subsystems, fonts, options);
+            } else if (options.gpu) {
+                run_gpu_demo(subsystems, fonts, options);
+            } else {
+                run_demo(subsystems, fonts, options);
+            }
+        }
+    }
+    trace_flush();
     std::cout<<"hello SDL ttf"<<std::endl;
-    return 0;
+    return status;
 }
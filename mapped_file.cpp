@@ -0,0 +1,84 @@
+
+#include "mapped_file.hpp"
+
+#include <SDL3/SDL_error.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        SDL_SetError("cannot open %s", path.c_str());
+        return nullptr;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        SDL_SetError("cannot map empty file %s", path.c_str());
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        SDL_SetError("cannot map %s", path.c_str());
+        return nullptr;
+    }
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        SDL_SetError("cannot map %s", path.c_str());
+        return nullptr;
+    }
+    std::shared_ptr<MappedFile> mapped(new MappedFile);
+    mapped->data_ = view;
+    mapped->size_ = static_cast<std::size_t>(size.QuadPart);
+    mapped->mapping_ = mapping;
+    return mapped;
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+}
+
+#else
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        SDL_SetError("cannot open %s", path.c_str());
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        SDL_SetError("cannot map empty file %s", path.c_str());
+        return nullptr;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        SDL_SetError("cannot map %s", path.c_str());
+        return nullptr;
+    }
+    std::shared_ptr<MappedFile> mapped(new MappedFile);
+    mapped->data_ = view;
+    mapped->size_ = static_cast<std::size_t>(info.st_size);
+    return mapped;
+}
+
+MappedFile::~MappedFile() {
+    munmap(const_cast<void*>(data_), size_);
+}
+
+#endif
@@ -0,0 +1,31 @@
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// A read-only memory mapping of a whole file. Pages are shared with every
+// other process mapping the same file and are only faulted in when read.
+class MappedFile {
+public:
+    // Returns nullptr with the SDL error set if the file cannot be mapped.
+    static std::shared_ptr<MappedFile> open(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    MappedFile() = default;
+
+    const void* data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void* mapping_ = nullptr;
+#endif
+};
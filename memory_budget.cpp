@@ -0,0 +1,81 @@
+
+#include "memory_budget.hpp"
+
+#include "trace.hpp"
+
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+#include <utility>
+
+MemoryBudget::MemoryBudget()
+    : MemoryBudget(Config{}) {}
+
+MemoryBudget::MemoryBudget(Config config)
+    : config_(config) {}
+
+void MemoryBudget::add(const char* name, const void* cache, float weight, std::function<std::size_t()> used, std::function<void(std::size_t)> set_limit) {
+    entries_.push_back(Entry{name, cache, std::max(weight, 0.0f), std::move(used), std::move(set_limit)});
+    total_weight_ += entries_.back().weight;
+    apply(config_.total_bytes);
+}
+
+void MemoryBudget::remove(const void* cache) {
+    std::erase_if(entries_, [cache](const Entry& entry) { return entry.cache == cache; });
+    total_weight_ = 0.0f;
+    for (const Entry& entry : entries_) {
+        total_weight_ += entry.weight;
+    }
+    apply(config_.total_bytes);
+}
+
+void MemoryBudget::set_total(std::size_t bytes) {
+    config_.total_bytes = bytes;
+    apply(bytes);
+}
+
+void MemoryBudget::trim(std::size_t target_bytes) {
+    TRACE_SCOPE("MemoryBudget::trim");
+    const std::size_t before = used();
+    apply(std::min(target_bytes, config_.total_bytes));
+    SDL_Log("MemoryBudget: trimmed text caches from %zu to %zu bytes", before, used());
+    apply(config_.total_bytes);
+}
+
+bool MemoryBudget::handle_event(const SDL_Event& event) {
+    if (event.type != SDL_EVENT_LOW_MEMORY) {
+        return false;
+    }
+    trim(static_cast<std::size_t>(static_cast<double>(config_.total_bytes) * config_.low_memory_fraction));
+    return true;
+}
+
+std::size_t MemoryBudget::used() const {
+    std::size_t bytes = 0;
+    for (const Entry& entry : entries_) {
+        bytes += entry.used();
+    }
+    return bytes;
+}
+
+std::vector<MemoryBudget::Usage> MemoryBudget::usage() const {
+    std::vector<Usage> result;
+    result.reserve(entries_.size());
+    for (const Entry& entry : entries_) {
+        result.push_back(Usage{entry.name, entry.used(), share(entry, config_.total_bytes)});
+    }
+    return result;
+}
+
+std::size_t MemoryBudget::share(const Entry& entry, std::size_t bytes) const {
+    if (total_weight_ <= 0.0f) {
+        return 0;
+    }
+    return static_cast<std::size_t>(static_cast<double>(bytes) * entry.weight / total_weight_);
+}
+
+void MemoryBudget::apply(std::size_t bytes) {
+    for (const Entry& entry : entries_) {
+        entry.set_limit(share(entry, bytes));
+    }
+}
@@ -0,0 +1,79 @@
+
+#pragma once
+
+#include <SDL3/SDL_events.h>
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// One memory budget shared by the text caches (GlyphAtlas,
+// ShapedRunCache, TextMeasureCache, FontFallback, or anything else with
+// memory_used() and set_memory_limit()). Each cache gets a slice of the
+// total in proportion to its weight, which replaces the limit in its own
+// Config, and enforces it itself, so no cache grows past its slice between
+// calls.
+//
+// On SDL_EVENT_LOW_MEMORY, which mobile platforms send before killing the
+// app, handle_event() trims every cache to its slice of
+// low_memory_fraction of the total and then restores the normal limits, so
+// caches shrink at once and refill only with what is used again.
+class MemoryBudget {
+public:
+    struct Config {
+        std::size_t total_bytes = 64 * 1024 * 1024;
+        float low_memory_fraction = 0.25f;
+    };
+
+    struct Usage {
+        const char* name;
+        std::size_t used;
+        std::size_t limit;
+    };
+
+    MemoryBudget();
+    explicit MemoryBudget(Config config);
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    // Registers cache, which must outlive the budget or be removed first,
+    // and rebalances every cache's limit. name must be a string literal or
+    // otherwise outlive the registration.
+    template <typename Cache>
+    void add(const char* name, Cache& cache, float weight = 1.0f) {
+        add(name, &cache, weight, [&cache] { return cache.memory_used(); }, [&cache](std::size_t bytes) { cache.set_memory_limit(bytes); });
+    }
+
+    void remove(const void* cache);
+
+    void set_total(std::size_t bytes);
+    std::size_t total() const { return config_.total_bytes; }
+
+    // Trims every cache down to its slice of target_bytes now, then gives
+    // them their normal limits back.
+    void trim(std::size_t target_bytes);
+
+    // Handles SDL_EVENT_LOW_MEMORY; returns false for any other event.
+    bool handle_event(const SDL_Event& event);
+
+    std::size_t used() const;
+    std::vector<Usage> usage() const;
+
+private:
+    struct Entry {
+        const char* name;
+        const void* cache;
+        float weight;
+        std::function<std::size_t()> used;
+        std::function<void(std::size_t)> set_limit;
+    };
+
+    void add(const char* name, const void* cache, float weight, std::function<std::size_t()> used, std::function<void(std::size_t)> set_limit);
+    std::size_t share(const Entry& entry, std::size_t bytes) const;
+    void apply(std::size_t bytes);
+
+    Config config_;
+    std::vector<Entry> entries_;
+    float total_weight_ = 0.0f;
+};
@@ -0,0 +1,62 @@
+
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+// Unbounded multi-producer single-consumer queue. push() is wait-free and
+// pop() never blocks, so worker threads can hand results to the render
+// thread without either side taking a lock. Only one thread may pop.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue()
+        : head_(&stub_), tail_(&stub_) {}
+
+    ~MpscQueue() {
+        while (pop()) {
+        }
+        if (tail_ != &stub_) {
+            delete tail_;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+        Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // A push that is still in progress may not be visible yet; it shows up
+    // on a later call.
+    std::optional<T> pop() {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return std::nullopt;
+        }
+        // next becomes the new stub once its value has been moved out.
+        std::optional<T> value = std::move(next->value);
+        next->value.reset();
+        tail_ = next;
+        if (tail != &stub_) {
+            delete tail;
+        }
+        return value;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> value;
+    };
+
+    Node stub_;
+    std::atomic<Node*> head_;
+    Node* tail_;
+};
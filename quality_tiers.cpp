@@ -0,0 +1,88 @@
+
+#include "quality_tiers.hpp"
+
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+#include <utility>
+
+std::vector<QualityTier> default_quality_tiers() {
+    return {
+        QualityTier{"high", TTF_HINTING_LIGHT_SUBPIXEL, GlyphRenderMode::blended},
+        QualityTier{"normal", TTF_HINTING_NORMAL, GlyphRenderMode::blended},
+        QualityTier{"fast", TTF_HINTING_NORMAL, GlyphRenderMode::shaded},
+        QualityTier{"fastest", TTF_HINTING_MONO, GlyphRenderMode::solid},
+    };
+}
+
+QualityController::QualityController(GlyphAtlas& atlas)
+    : QualityController(atlas, Config{}) {}
+
+QualityController::QualityController(GlyphAtlas& atlas, Config config)
+    : atlas_(atlas), config_(std::move(config)) {
+    if (config_.tiers.empty()) {
+        config_.tiers = default_quality_tiers();
+    }
+    apply();
+}
+
+void QualityController::add_font(TTF_Font* font) {
+    if (font == nullptr || std::find(fonts_.begin(), fonts_.end(), font) != fonts_.end()) {
+        return;
+    }
+    fonts_.push_back(font);
+    TTF_SetFontHinting(font, tier().hinting);
+    TTF_SetFontSDF(font, tier().sdf);
+}
+
+void QualityController::remove_font(TTF_Font* font) {
+    std::erase(fonts_, font);
+}
+
+void QualityController::set_tier(std::size_t index) {
+    preferred_ = std::min(index, config_.tiers.size() - 1);
+    switch_to(preferred_);
+}
+
+bool QualityController::end_frame(double frame_ms) {
+    if (!config_.automatic) {
+        return false;
+    }
+    if (frame_ms > config_.frame_budget_ms) {
+        fast_ = 0;
+        if (++slow_ >= config_.slow_frames && current_ + 1 < config_.tiers.size()) {
+            switch_to(current_ + 1);
+            return true;
+        }
+    } else if (frame_ms < config_.frame_budget_ms * config_.headroom) {
+        slow_ = 0;
+        if (++fast_ >= config_.fast_frames && current_ > preferred_) {
+            switch_to(current_ - 1);
+            return true;
+        }
+    } else {
+        slow_ = 0;
+        fast_ = 0;
+    }
+    return false;
+}
+
+void QualityController::switch_to(std::size_t index) {
+    slow_ = 0;
+    fast_ = 0;
+    if (index == current_) {
+        return;
+    }
+    current_ = index;
+    SDL_Log("QualityController: text quality %s", tier().name);
+    apply();
+}
+
+void QualityController::apply() {
+    const QualityTier& active = tier();
+    atlas_.set_render_mode(active.mode);
+    for (TTF_Font* font : fonts_) {
+        TTF_SetFontHinting(font, active.hinting);
+        TTF_SetFontSDF(font, active.sdf);
+    }
+}
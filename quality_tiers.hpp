@@ -0,0 +1,85 @@
+
+#pragma once
+
+#include "glyph_atlas.hpp"
+#include "glyph_raster.hpp"
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <vector>
+
+// One text quality setting: how outlines are hinted, how coverage is
+// rasterized, and whether glyphs are rendered as distance fields.
+struct QualityTier {
+    const char* name;
+    TTF_HintingFlags hinting;
+    GlyphRenderMode mode;
+    // Only for back ends that threshold the field (GpuTextRenderer,
+    // SurfaceTextRenderer); TextBatch would draw the raw field.
+    bool sdf = false;
+};
+
+// high: light subpixel hinting, blended. normal: normal hinting, blended.
+// fast: normal hinting, shaded. fastest: mono hinting, solid.
+std::vector<QualityTier> default_quality_tiers();
+
+// Applies quality tiers, ordered best first, to a GlyphAtlas and a set of
+// fonts, and can step down to a cheaper tier by itself when frames run
+// over budget, e.g. while scrolling on low-end hardware.
+//
+// Every key the atlas and ShapedRunCache use includes the hinting and
+// render mode, so a tier switch rasterizes the glyphs of the new tier as
+// they are drawn while the old tier's stay cached for a switch back.
+// Layouts that measure text (TextLayout, TextMeasureCache) re-measure
+// since hinting changes the font generation.
+class QualityController {
+public:
+    struct Config {
+        std::vector<QualityTier> tiers = default_quality_tiers();
+        double frame_budget_ms = 1000.0 / 60.0;
+        // Steps down after this many frames over budget in a row.
+        int slow_frames = 8;
+        // Steps back up, never past the tier set with set_tier(), after
+        // this many frames under headroom * frame_budget_ms in a row.
+        int fast_frames = 120;
+        double headroom = 0.5;
+        bool automatic = true;
+    };
+
+    explicit QualityController(GlyphAtlas& atlas);
+    QualityController(GlyphAtlas& atlas, Config config);
+
+    QualityController(const QualityController&) = delete;
+    QualityController& operator=(const QualityController&) = delete;
+
+    // Applies the current tier's hinting and SDF flag to font, now and on
+    // every switch. Adding a font twice does nothing. Faces from
+    // FontManager::open_sdf() should only be added if every tier sets sdf.
+    void add_font(TTF_Font* font);
+    void remove_font(TTF_Font* font);
+
+    // Switches to tier index (0 is best) and makes it the best tier
+    // automatic switching returns to.
+    void set_tier(std::size_t index);
+    std::size_t tier_index() const { return current_; }
+    const QualityTier& tier() const { return config_.tiers[current_]; }
+
+    void set_automatic(bool automatic) { config_.automatic = automatic; }
+
+    // Reports how long the frame took. Returns true if the tier changed,
+    // in which case everything on screen should be redrawn.
+    bool end_frame(double frame_ms);
+
+private:
+    void apply();
+    void switch_to(std::size_t index);
+
+    GlyphAtlas& atlas_;
+    Config config_;
+    std::vector<TTF_Font*> fonts_;
+    std::size_t current_ = 0;
+    std::size_t preferred_ = 0;
+    int slow_ = 0;
+    int fast_ = 0;
+};
@@ -0,0 +1,329 @@
+
+#include "font_manager.hpp"
+#include "shaped_run_cache.hpp"
+#include "surface_text.hpp"
+#include "text_layout.hpp"
+#include "text_pool.hpp"
+
+#include <SDL3/SDL_cpuinfo.h>
+#include <SDL3/SDL_init.h>
+#include <SDL3/SDL_platform.h>
+#include <SDL3/SDL_surface.h>
+#include <SDL3/SDL_timer.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Renders fixed headless scenes and checks their frame times and memory
+// against a checked-in baseline, so a dependency bump that slows text
+// rendering fails the container build:
+//
+//   scenario_runner [--frames N] [--tolerance F] [--baseline FILE]
+//                   [--write-baseline FILE] --latin PATH [--cjk PATH]
+//
+// Each scene draws frames into an ARGB8888 surface and reports the first
+// frame, which includes rasterizing every glyph, and the p50 and p99 of
+// the rest. p50, p99 and peak RSS fail when they exceed their baseline by
+// more than the tolerance, 0.2 (20%) by default. The first frame is a
+// single sample, too noisy for any fixed threshold, so it is only printed.
+// Scenes whose font is not given are skipped.
+//
+// The baseline holds one "name value" pair per line; lines starting with
+// '#' are comments. --write-baseline records the current run in that format,
+// with the machine it ran on in a comment.
+
+namespace {
+
+constexpr int frame_w = 1920;
+constexpr int frame_h = 1080;
+
+constexpr std::string_view latin_lines[] = {
+    "The quick brown fox jumps over the lazy dog 0123456789",
+    "Pack my box with five dozen liquor jugs, then ship it (fast!)",
+    "2024-05-17 12:00:03.417 INFO  net: connection 42 accepted from 10.0.0.7",
+    "Sphinx of black quartz, judge my vow; how vexingly quick daft zebras jump",
+};
+
+constexpr std::string_view cjk_lines[] = {
+    "\xe6\x88\x91\xe8\x83\xbd\xe5\x90\x9e\xe4\xb8\x8b\xe7\x8e\xbb\xe7\x92\x83\xe8\x80\x8c\xe4\xb8\x8d\xe4\xbc\xa4\xe8\xba\xab\xe4\xbd\x93\xe3\x80\x82",
+    "\xe6\x95\xb0\xe6\x8d\xae\xe5\xba\x93\xe8\xbf\x9e\xe6\x8e\xa5\xe5\xb7\xb2\xe6\x96\xad\xe5\xbc\x80\xef\xbc\x8c\xe8\xaf\xb7\xe7\xa8\x8d\xe5\x90\x8e\xe9\x87\x8d\xe8\xaf\x95",
+    "\xe3\x81\x84\xe3\x82\x8d\xe3\x81\xaf\xe3\x81\xab\xe3\x81\xbb\xe3\x81\xb8\xe3\x81\xa8\xe3\x81\xa1\xe3\x82\x8a\xe3\x81\xac\xe3\x82\x8b\xe3\x82\x92",
+    "\xed\x82\xa4\xec\x8a\xa4\xec\x9d\x98 \xea\xb3\xa0\xec\x9c\xa0\xec\xa1\xb0\xea\xb1\xb4\xec\x9d\x80 \xec\x9e\x85\xec\x88\xa0\xeb\x81\xbc\xeb\xa6\xac",
+};
+
+struct Options {
+    int frames = 300;
+    double tolerance = 0.2;
+    const char* baseline = nullptr;
+    const char* write_baseline = nullptr;
+    const char* latin = nullptr;
+    const char* cjk = nullptr;
+};
+
+struct Scene {
+    std::string name;
+    // Draws frame number `frame` into the surface, which is already cleared.
+    std::function<void(SDL_Surface*, int)> draw;
+};
+
+double peak_rss_mb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0.0;
+    }
+    return static_cast<double>(counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0);
+#else
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+#endif
+#endif
+}
+
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const auto rank = static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(rank), values.end());
+    return values[rank];
+}
+
+// Runs a scene and adds its <name>.first_ms, .p50_ms and .p99_ms metrics.
+bool run_scene(const Scene& scene, int frames, std::map<std::string, double>& metrics) {
+    SDL_Surface* surface = SDL_CreateSurface(frame_w, frame_h, SDL_PIXELFORMAT_ARGB8888);
+    if (surface == nullptr) {
+        std::cout<<"failed to create surface: "<<SDL_GetError()<<std::endl;
+        return false;
+    }
+    const Uint32 background = SDL_MapSurfaceRGBA(surface, 16, 16, 24, 255);
+    std::vector<double> times;
+    times.reserve(static_cast<std::size_t>(frames));
+    for (int frame = 0; frame < frames; ++frame) {
+        const Uint64 start = SDL_GetTicksNS();
+        SDL_FillSurfaceRect(surface, nullptr, background);
+        scene.draw(surface, frame);
+        times.push_back(static_cast<double>(SDL_GetTicksNS() - start) / 1e6);
+    }
+    SDL_DestroySurface(surface);
+    metrics[scene.name + ".first_ms"] = times.front();
+    times.erase(times.begin());
+    metrics[scene.name + ".p50_ms"] = percentile(times, 0.50);
+    metrics[scene.name + ".p99_ms"] = percentile(times, 0.99);
+    std::cout<<std::fixed<<std::setprecision(2)<<scene.name<<": first "<<metrics[scene.name + ".first_ms"]<<" ms, p50 "<<metrics[scene.name + ".p50_ms"]<<" ms, p99 "<<metrics[scene.name + ".p99_ms"]<<" ms"<<std::endl;
+    return true;
+}
+
+// Lines of text filling the frame, the same every frame.
+Scene dense_scene(const char* name, SurfaceTextRenderer& text, TTF_Font* font, const std::string_view* lines, std::size_t line_count) {
+    return Scene{name, [&text, font, lines, line_count](SDL_Surface* surface, int) {
+        const int skip = std::max(TTF_GetFontLineSkip(font), 1);
+        std::size_t line = 0;
+        for (int y = 0; y + skip <= frame_h; y += skip) {
+            // Several copies per row so each line runs the full width.
+            int x = 0;
+            for (int copy = 0; copy < 3; ++copy) {
+                text.draw(surface, font, lines[line % line_count], x, y, SDL_Color{220, 220, 230, 255});
+                x += frame_w / 3;
+            }
+            ++line;
+        }
+    }};
+}
+
+// Whether a metric is checked against the baseline.
+bool gated(const std::string& name) {
+    return !name.ends_with(".first_ms");
+}
+
+bool read_baseline(const char* path, std::map<std::string, double>& baseline) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout<<"failed to read baseline "<<path<<std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string name;
+        double value = 0.0;
+        if (fields>>name>>value) {
+            baseline[name] = value;
+        }
+    }
+    return true;
+}
+
+bool write_baseline(const char* path, const std::map<std::string, double>& metrics, int frames) {
+    std::ofstream file(path);
+    // The values only mean something on the kind of machine that measured
+    // them, so say which one that was.
+    file<<"# Measured by scenario_runner --write-baseline, "<<frame_w<<"x"<<frame_h<<", "<<frames<<" frames per scene, on "<<SDL_GetPlatform()<<" with "<<SDL_GetNumLogicalCPUCores()<<" logical cores and "<<SDL_GetSystemRAM()<<" MB RAM."<<std::endl;
+    for (const auto& [name, value] : metrics) {
+        if (gated(name)) {
+            file<<name<<" "<<std::fixed<<std::setprecision(2)<<value<<std::endl;
+        }
+    }
+    if (!file) {
+        std::cout<<"failed to write baseline "<<path<<std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Returns false if any gated metric in both maps regressed past tolerance.
+bool check_against(const std::map<std::string, double>& metrics, const std::map<std::string, double>& baseline, double tolerance) {
+    bool ok = true;
+    for (const auto& [name, limit] : baseline) {
+        if (!gated(name)) {
+            continue;
+        }
+        const auto it = metrics.find(name);
+        if (it == metrics.end()) {
+            std::cout<<name<<": not measured"<<std::endl;
+            continue;
+        }
+        const double allowed = limit * (1.0 + tolerance);
+        if (it->second > allowed) {
+            std::cout<<std::fixed<<std::setprecision(2)<<"REGRESSION "<<name<<": "<<it->second<<" > "<<allowed<<" (baseline "<<limit<<")"<<std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+Options parse_options(int argc, char* argv[], bool& valid) {
+    Options options;
+    valid = true;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options.frames = std::max(std::atoi(argv[++i]), 2);
+        } else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            options.tolerance = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            options.baseline = argv[++i];
+        } else if (std::strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc) {
+            options.write_baseline = argv[++i];
+        } else if (std::strcmp(argv[i], "--latin") == 0 && i + 1 < argc) {
+            options.latin = argv[++i];
+        } else if (std::strcmp(argv[i], "--cjk") == 0 && i + 1 < argc) {
+            options.cjk = argv[++i];
+        } else {
+            valid = false;
+        }
+    }
+    valid = valid && options.latin != nullptr;
+    return options;
+}
+
+int run(const Options& options) {
+    FontManager fonts;
+    const FontHandle latin = fonts.open(options.latin, 16.0f);
+    if (!latin) {
+        std::cout<<"failed to open "<<options.latin<<": "<<SDL_GetError()<<std::endl;
+        return 1;
+    }
+    const FontHandle cjk = options.cjk != nullptr ? fonts.open(options.cjk, 16.0f) : FontHandle();
+    if (options.cjk != nullptr && !cjk) {
+        std::cout<<"failed to open "<<options.cjk<<": "<<SDL_GetError()<<std::endl;
+        return 1;
+    }
+
+    ShapedRunCache runs;
+    SurfaceTextRenderer text(runs);
+    std::map<std::string, double> metrics;
+    bool ok = run_scene(dense_scene("dense", text, latin.get(), latin_lines, std::size(latin_lines)), options.frames, metrics);
+
+    // A long log scrolled a little further every frame, through the
+    // incremental layout and the surface text engine. Texts of lines that
+    // scroll away are recycled for the ones coming into view.
+    TTF_TextEngine* engine = TTF_CreateSurfaceTextEngine();
+    if (engine == nullptr) {
+        std::cout<<"failed to create text engine: "<<SDL_GetError()<<std::endl;
+        return 1;
+    }
+    {
+        TextPool pool(engine);
+        TextLayout::Config layout_config;
+        layout_config.pool = &pool;
+        TextLayout layout(engine, latin.get(), frame_w - 16, layout_config);
+        for (int i = 0; i < 20000; ++i) {
+            layout.append(latin_lines[static_cast<std::size_t>(i) % std::size(latin_lines)]);
+            layout.append("\n");
+        }
+        const Scene scroll{"scroll", [&layout](SDL_Surface* surface, int frame) {
+            const float scroll_y = static_cast<float>(frame) * 23.0f;
+            for (const TextLayout::VisibleParagraph& visible : layout.layout_visible(scroll_y, frame_h)) {
+                TTF_DrawSurfaceText(visible.text, 8, static_cast<int>(visible.y - scroll_y), surface);
+            }
+        }};
+        ok = run_scene(scroll, options.frames, metrics) && ok;
+    }
+    TTF_DestroySurfaceTextEngine(engine);
+
+    if (cjk) {
+        ok = run_scene(dense_scene("cjk", text, cjk.get(), cjk_lines, std::size(cjk_lines)), options.frames, metrics) && ok;
+    } else {
+        std::cout<<"cjk: skipped, no --cjk font"<<std::endl;
+    }
+
+    metrics["peak_rss_mb"] = peak_rss_mb();
+    std::cout<<std::fixed<<std::setprecision(1)<<"peak RSS "<<metrics["peak_rss_mb"]<<" MB"<<std::endl;
+
+    if (options.write_baseline != nullptr && !write_baseline(options.write_baseline, metrics, options.frames)) {
+        ok = false;
+    }
+    if (options.baseline != nullptr) {
+        std::map<std::string, double> baseline;
+        if (!read_baseline(options.baseline, baseline) || !check_against(metrics, baseline, options.tolerance)) {
+            ok = false;
+        } else {
+            std::cout<<"within "<<static_cast<int>(options.tolerance * 100.0)<<"% of "<<options.baseline<<std::endl;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool valid = false;
+    const Options options = parse_options(argc, argv, valid);
+    if (!valid) {
+        std::cout<<"usage: scenario_runner [--frames N] [--tolerance F] [--baseline FILE] [--write-baseline FILE] --latin PATH [--cjk PATH]"<<std::endl;
+        return 1;
+    }
+    SDL_Init(0);
+    TTF_Init();
+    const int status = run(options);
+    TTF_Quit();
+    SDL_Quit();
+    return status;
+}
@@ -0,0 +1,152 @@
+
+#include "sdl_allocator.hpp"
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+// Every block starts with a header recording its size class, padded so the
+// payload keeps malloc's alignment.
+struct alignas(std::max_align_t) Header {
+    std::size_t size_class;
+};
+
+constexpr std::size_t large_class = ~std::size_t{0};
+constexpr std::array<std::size_t, 7> class_sizes{32, 64, 128, 256, 512, 1024, 2048};
+// Caps how many idle blocks one thread keeps per class.
+constexpr std::size_t max_cached_per_class = 256;
+
+SDL_malloc_func original_malloc = nullptr;
+SDL_calloc_func original_calloc = nullptr;
+SDL_realloc_func original_realloc = nullptr;
+SDL_free_func original_free = nullptr;
+
+std::atomic<std::size_t> system_allocations{0};
+std::atomic<std::size_t> recycled_allocations{0};
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct ThreadCache {
+    std::array<FreeBlock*, class_sizes.size()> heads{};
+    std::array<std::size_t, class_sizes.size()> counts{};
+
+    ~ThreadCache() {
+        for (FreeBlock* block : heads) {
+            while (block != nullptr) {
+                FreeBlock* next = block->next;
+                original_free(reinterpret_cast<Header*>(block) - 1);
+                block = next;
+            }
+        }
+    }
+};
+
+ThreadCache& thread_cache() {
+    thread_local ThreadCache cache;
+    return cache;
+}
+
+std::size_t class_for(std::size_t size) {
+    for (std::size_t i = 0; i < class_sizes.size(); ++i) {
+        if (size <= class_sizes[i]) {
+            return i;
+        }
+    }
+    return large_class;
+}
+
+Header* header_of(void* payload) {
+    return static_cast<Header*>(payload) - 1;
+}
+
+void* pooled_malloc(std::size_t size) {
+    const std::size_t size_class = class_for(size);
+    if (size_class != large_class) {
+        ThreadCache& cache = thread_cache();
+        if (FreeBlock* block = cache.heads[size_class]) {
+            cache.heads[size_class] = block->next;
+            --cache.counts[size_class];
+            recycled_allocations.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+    }
+    const std::size_t payload = size_class != large_class ? class_sizes[size_class] : size;
+    auto* header = static_cast<Header*>(original_malloc(sizeof(Header) + payload));
+    if (header == nullptr) {
+        return nullptr;
+    }
+    system_allocations.fetch_add(1, std::memory_order_relaxed);
+    header->size_class = size_class;
+    return header + 1;
+}
+
+void pooled_free(void* payload) {
+    if (payload == nullptr) {
+        return;
+    }
+    Header* header = header_of(payload);
+    const std::size_t size_class = header->size_class;
+    if (size_class != large_class) {
+        ThreadCache& cache = thread_cache();
+        if (cache.counts[size_class] < max_cached_per_class) {
+            auto* block = static_cast<FreeBlock*>(payload);
+            block->next = cache.heads[size_class];
+            cache.heads[size_class] = block;
+            ++cache.counts[size_class];
+            return;
+        }
+    }
+    original_free(header);
+}
+
+void* pooled_calloc(std::size_t count, std::size_t size) {
+    if (size != 0 && count > ~std::size_t{0} / size) {
+        return nullptr;
+    }
+    void* payload = pooled_malloc(count * size);
+    if (payload != nullptr) {
+        std::memset(payload, 0, count * size);
+    }
+    return payload;
+}
+
+void* pooled_realloc(void* payload, std::size_t size) {
+    if (payload == nullptr) {
+        return pooled_malloc(size);
+    }
+    Header* header = header_of(payload);
+    if (header->size_class == large_class && class_for(size) == large_class) {
+        auto* grown = static_cast<Header*>(original_realloc(header, sizeof(Header) + size));
+        return grown != nullptr ? grown + 1 : nullptr;
+    }
+    if (header->size_class != large_class && size <= class_sizes[header->size_class]) {
+        return payload;
+    }
+    void* moved = pooled_malloc(size);
+    if (moved == nullptr) {
+        return nullptr;
+    }
+    // A pooled block holds exactly its class size; a large one was asked for
+    // with at least as many bytes as the new class can hold.
+    const std::size_t old_size = header->size_class != large_class ? class_sizes[header->size_class] : size;
+    std::memcpy(moved, payload, old_size < size ? old_size : size);
+    pooled_free(payload);
+    return moved;
+}
+
+} // namespace
+
+bool install_sdl_allocator() {
+    SDL_GetOriginalMemoryFunctions(&original_malloc, &original_calloc, &original_realloc, &original_free);
+    return SDL_SetMemoryFunctions(pooled_malloc, pooled_calloc, pooled_realloc, pooled_free);
+}
+
+SdlAllocatorStats sdl_allocator_stats() {
+    return SdlAllocatorStats{system_allocations.load(std::memory_order_relaxed), recycled_allocations.load(std::memory_order_relaxed)};
+}
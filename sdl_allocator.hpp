@@ -0,0 +1,29 @@
+
+#pragma once
+
+#include <cstddef>
+
+// Replaces SDL's allocator with one that recycles small blocks through
+// per-thread size-class free lists, so the short-lived buffers SDL and
+// SDL3_ttf allocate while measuring and rendering text stop reaching
+// malloc/free. Larger blocks go straight to the original allocator.
+//
+// SDL's allocator cannot be a frame arena: SDL and SDL3_ttf keep some of
+// what they allocate (glyph caches, textures, surfaces) across frames, so
+// reclaiming it at a frame boundary would leave them with dangling memory.
+// Scratch memory of our own goes through frame_arena() instead.
+//
+// Must be called before SDL_Init() and before anything else allocates
+// through SDL, since every block freed through SDL must have come from the
+// same allocator. Returns false if SDL refused the replacement.
+bool install_sdl_allocator();
+
+struct SdlAllocatorStats {
+    // Calls that had to reach the original allocator.
+    std::size_t system_allocations;
+    // Calls served from a free list.
+    std::size_t recycled_allocations;
+};
+
+// Totals since install_sdl_allocator(), summed over every thread.
+SdlAllocatorStats sdl_allocator_stats();
@@ -0,0 +1,24 @@
+#version 450
+
+// One glyph per instance, expanded into a four-vertex strip: corner
+// (0,0), (1,0), (0,1), (1,1) from gl_VertexIndex.
+
+layout(location = 0) in vec4 in_rect;
+layout(location = 1) in vec4 in_uv;
+layout(location = 2) in vec4 in_color;
+
+layout(location = 0) out vec2 out_uv;
+layout(location = 1) out vec4 out_color;
+
+// SDL_GPU binds vertex uniform buffers in set 1. scale is 2 / target size.
+layout(set = 1, binding = 0) uniform Target {
+    vec2 scale;
+} target;
+
+void main() {
+    vec2 corner = vec2(float(gl_VertexIndex & 1), float(gl_VertexIndex >> 1));
+    vec2 position = in_rect.xy + corner * in_rect.zw;
+    out_uv = in_uv.xy + corner * in_uv.zw;
+    out_color = in_color;
+    gl_Position = vec4(position.x * target.scale.x - 1.0, 1.0 - position.y * target.scale.y, 0.0, 1.0);
+}
@@ -0,0 +1,13 @@
+#version 450
+
+layout(location = 0) in vec2 in_uv;
+layout(location = 1) in vec4 in_color;
+
+layout(location = 0) out vec4 out_color;
+
+// SDL_GPU binds fragment samplers in set 2.
+layout(set = 2, binding = 0) uniform sampler2D atlas;
+
+void main() {
+    out_color = vec4(in_color.rgb, in_color.a * texture(atlas, in_uv).a);
+}
@@ -0,0 +1,19 @@
+#version 450
+
+layout(location = 0) in vec2 in_uv;
+layout(location = 1) in vec4 in_color;
+
+layout(location = 0) out vec4 out_color;
+
+// SDL_GPU binds fragment samplers in set 2.
+layout(set = 2, binding = 0) uniform sampler2D atlas;
+
+void main() {
+    // SDL3_ttf stores the outline at 0.5. fwidth gives how far the field
+    // moves across one screen pixel, so the edge stays one pixel wide at
+    // any scale.
+    float distance = texture(atlas, in_uv).a;
+    float width = max(fwidth(distance), 1.0 / 255.0);
+    float coverage = clamp((distance - 0.5) / width + 0.5, 0.0, 1.0);
+    out_color = vec4(in_color.rgb, in_color.a * coverage);
+}
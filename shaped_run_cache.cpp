@@ -0,0 +1,139 @@
+
+#include "shaped_run_cache.hpp"
+
+#include "frame_arena.hpp"
+#include "text_stats.hpp"
+#include "utf8.hpp"
+
+#include <functional>
+
+std::size_t ShapedRunCache::KeyHash::operator()(const KeyView& key) const noexcept {
+    std::size_t h = std::hash<std::string_view>{}(key.text);
+    h ^= std::hash<const void*>{}(key.font) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= std::hash<float>{}(key.size) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= std::hash<int>{}(static_cast<int>(key.hinting)) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+ShapedRunCache::ShapedRunCache()
+    : ShapedRunCache(Config{}) {}
+
+ShapedRunCache::ShapedRunCache(Config config)
+    : config_(config) {}
+
+const ShapedRun* ShapedRunCache::shape(TTF_Font* font, std::string_view text) {
+    const Uint32 epoch = epoch_for(font);
+    const KeyView probe{font, TTF_GetFontSize(font), TTF_GetFontHinting(font), text};
+    auto it = entries_.find(probe);
+    if (it != entries_.end()) {
+        if (it->second.epoch == epoch) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            ++text_stats().run_hits;
+            return &it->second.run;
+        }
+        erase(it);
+    }
+
+    ++text_stats().run_misses;
+    ShapedRun run;
+    if (!build(font, text, run)) {
+        return nullptr;
+    }
+    const std::size_t bytes = sizeof(Key) + sizeof(Entry) + text.size() + run.glyphs.capacity() * sizeof(ShapedGlyph);
+    it = entries_.emplace(Key{font, probe.size, probe.hinting, std::string(text)}, Entry{std::move(run), epoch, bytes, {}}).first;
+    lru_.push_front(&it->first);
+    it->second.lru = lru_.begin();
+    bytes_ += bytes;
+    trim();
+    return &it->second.run;
+}
+
+void ShapedRunCache::forget(TTF_Font* font) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        const auto next = std::next(it);
+        if (it->first.font == font) {
+            erase(it);
+        }
+        it = next;
+    }
+    fonts_.erase(font);
+}
+
+void ShapedRunCache::clear() {
+    entries_.clear();
+    lru_.clear();
+    fonts_.clear();
+    bytes_ = 0;
+}
+
+void ShapedRunCache::set_memory_limit(std::size_t bytes) {
+    config_.max_bytes = bytes;
+    trim();
+}
+
+Uint32 ShapedRunCache::epoch_for(TTF_Font* font) {
+    const Uint32 generation = TTF_GetFontGeneration(font);
+    auto [it, inserted] = fonts_.try_emplace(font);
+    FontState& state = it->second;
+    if (inserted) {
+        state = FontState{generation, TTF_GetFontStyle(font), TTF_GetFontOutline(font), 0};
+    } else if (state.generation != generation) {
+        const TTF_FontStyleFlags style = TTF_GetFontStyle(font);
+        const int outline = TTF_GetFontOutline(font);
+        if (style != state.style || outline != state.outline) {
+            ++state.epoch;
+        }
+        state = FontState{generation, style, outline, state.epoch};
+    }
+    return state.epoch;
+}
+
+bool ShapedRunCache::build(TTF_Font* font, std::string_view text, ShapedRun& run) {
+    TtfTimer timer;
+    if (!TTF_GetStringSize(font, text.data(), text.size(), &run.width, &run.height)) {
+        return false;
+    }
+    // Worst case is one glyph per byte; lay out into frame scratch and copy
+    // the exact count into the run.
+    const FrameArena::Scope scratch(frame_arena());
+    ScratchVector<ShapedGlyph> glyphs = make_scratch_vector<ShapedGlyph>();
+    glyphs.reserve(text.size());
+    const float line_skip = static_cast<float>(TTF_GetFontLineSkip(font));
+    float pen_x = 0.0f;
+    float pen_y = 0.0f;
+    Uint32 previous = 0;
+    for (std::size_t pos = 0; pos < text.size();) {
+        const Uint32 codepoint = utf8_next(text, pos);
+        if (codepoint == '\n') {
+            pen_x = 0.0f;
+            pen_y += line_skip;
+            previous = 0;
+            continue;
+        }
+        int kerning = 0;
+        if (previous != 0 && TTF_GetGlyphKerning(font, previous, codepoint, &kerning)) {
+            pen_x += static_cast<float>(kerning);
+        }
+        previous = codepoint;
+        int advance = 0;
+        if (!TTF_GetGlyphMetrics(font, codepoint, nullptr, nullptr, nullptr, nullptr, &advance)) {
+            continue;
+        }
+        glyphs.push_back(ShapedGlyph{codepoint, pen_x, pen_y});
+        pen_x += static_cast<float>(advance);
+    }
+    run.glyphs.assign(glyphs.begin(), glyphs.end());
+    return true;
+}
+
+void ShapedRunCache::erase(Map::iterator it) {
+    bytes_ -= it->second.bytes;
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+void ShapedRunCache::trim() {
+    while (bytes_ > config_.max_bytes && lru_.size() > 1) {
+        erase(entries_.find(*lru_.back()));
+    }
+}
@@ -0,0 +1,120 @@
+
+#pragma once
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// One glyph of a shaped string, positioned relative to the string's top-left.
+struct ShapedGlyph {
+    Uint32 codepoint;
+    float x;
+    float y;
+};
+
+struct ShapedRun {
+    std::vector<ShapedGlyph> glyphs;
+    int width = 0;
+    int height = 0;
+};
+
+// Remembers the glyph sequence, pen positions and bounding box of strings
+// keyed by (font, size, hinting, text), so static labels are decoded,
+// kerned and measured once rather than every frame.
+//
+// Entries are tied to a per-font epoch that advances whenever
+// TTF_GetFontGeneration() reports a style or outline change. Resizing a
+// font or switching its hinting, as quality tiers do, keeps the entries of
+// every size and hinting alive since both are part of the key.
+// The least recently used runs are dropped once max_bytes is exceeded.
+class ShapedRunCache {
+public:
+    struct Config {
+        std::size_t max_bytes = 4 * 1024 * 1024;
+    };
+
+    ShapedRunCache();
+    explicit ShapedRunCache(Config config);
+
+    // Returns nullptr only if the font cannot measure the text. The pointer
+    // is valid until the next call to shape().
+    const ShapedRun* shape(TTF_Font* font, std::string_view text);
+
+    // Drops every run shaped with the font, e.g. from a
+    // FontManager::on_close() listener.
+    void forget(TTF_Font* font);
+    void clear();
+
+    // Lowers or raises max_bytes, dropping runs at once if over it.
+    void set_memory_limit(std::size_t bytes);
+
+    std::size_t memory_used() const { return bytes_; }
+    std::size_t run_count() const { return entries_.size(); }
+
+private:
+    struct Key {
+        TTF_Font* font;
+        float size;
+        TTF_HintingFlags hinting;
+        std::string text;
+    };
+
+    struct KeyView {
+        TTF_Font* font;
+        float size;
+        TTF_HintingFlags hinting;
+        std::string_view text;
+    };
+
+    // Transparent so lookups with a KeyView do not copy the text.
+    struct KeyHash {
+        using is_transparent = void;
+        std::size_t operator()(const KeyView& key) const noexcept;
+        std::size_t operator()(const Key& key) const noexcept { return (*this)(KeyView{key.font, key.size, key.hinting, key.text}); }
+    };
+
+    struct KeyEqual {
+        using is_transparent = void;
+        static KeyView view(const Key& key) { return KeyView{key.font, key.size, key.hinting, key.text}; }
+        static KeyView view(const KeyView& key) { return key; }
+        template <typename A, typename B>
+        bool operator()(const A& a, const B& b) const noexcept {
+            const KeyView x = view(a);
+            const KeyView y = view(b);
+            return x.font == y.font && x.size == y.size && x.hinting == y.hinting && x.text == y.text;
+        }
+    };
+
+    struct Entry {
+        ShapedRun run;
+        Uint32 epoch;
+        std::size_t bytes;
+        std::list<const Key*>::iterator lru;
+    };
+
+    using Map = std::unordered_map<Key, Entry, KeyHash, KeyEqual>;
+
+    struct FontState {
+        Uint32 generation;
+        TTF_FontStyleFlags style;
+        int outline;
+        Uint32 epoch;
+    };
+
+    Uint32 epoch_for(TTF_Font* font);
+    bool build(TTF_Font* font, std::string_view text, ShapedRun& run);
+    void erase(Map::iterator it);
+    void trim();
+
+    Config config_;
+    Map entries_;
+    // Points at keys inside entries_, which stay put until erased.
+    std::list<const Key*> lru_;
+    std::unordered_map<TTF_Font*, FontState> fonts_;
+    std::size_t bytes_ = 0;
+};
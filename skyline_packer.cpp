@@ -0,0 +1,138 @@
+
+#include "skyline_packer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+SkylinePacker::SkylinePacker(int size)
+    : SkylinePacker(size, 0) {}
+
+SkylinePacker::SkylinePacker(int size, int reserved_height)
+    : size_(size), reserved_height_(reserved_height) {
+    reset();
+}
+
+bool SkylinePacker::pack(int w, int h, SDL_Rect& rect) {
+    if (w <= 0 || h <= 0 || w > size_ || h > size_) {
+        return false;
+    }
+    if (pack_gap(w, h, rect)) {
+        return true;
+    }
+    std::size_t best = skyline_.size();
+    int best_top = std::numeric_limits<int>::max();
+    int best_hidden = std::numeric_limits<int>::max();
+    int best_y = 0;
+    for (std::size_t i = 0; i < skyline_.size(); ++i) {
+        int hidden = 0;
+        const int y = fit(i, w, h, hidden);
+        if (y >= 0 && (y + h < best_top || (y + h == best_top && hidden < best_hidden))) {
+            best = i;
+            best_top = y + h;
+            best_hidden = hidden;
+            best_y = y;
+        }
+    }
+    if (best == skyline_.size()) {
+        return false;
+    }
+    rect = SDL_Rect{skyline_[best].x, best_y, w, h};
+    place(best, rect);
+    return true;
+}
+
+void SkylinePacker::reset() {
+    skyline_.assign(1, Segment{0, reserved_height_, size_});
+    gaps_.clear();
+}
+
+int SkylinePacker::used_height() const {
+    int height = 0;
+    for (const Segment& segment : skyline_) {
+        height = std::max(height, segment.y);
+    }
+    return height;
+}
+
+// Takes the smallest gap the rectangle fits in and splits what is left of
+// it along the shorter leftover side, keeping the larger piece whole.
+bool SkylinePacker::pack_gap(int w, int h, SDL_Rect& rect) {
+    auto best = gaps_.end();
+    for (auto it = gaps_.begin(); it != gaps_.end(); ++it) {
+        if (it->w >= w && it->h >= h && (best == gaps_.end() || it->w * it->h < best->w * best->h)) {
+            best = it;
+        }
+    }
+    if (best == gaps_.end()) {
+        return false;
+    }
+    const SDL_Rect gap = *best;
+    *best = gaps_.back();
+    gaps_.pop_back();
+    rect = SDL_Rect{gap.x, gap.y, w, h};
+    SDL_Rect right;
+    SDL_Rect above;
+    if (gap.w - w > gap.h - h) {
+        right = SDL_Rect{gap.x + w, gap.y, gap.w - w, gap.h};
+        above = SDL_Rect{gap.x, gap.y + h, w, gap.h - h};
+    } else {
+        right = SDL_Rect{gap.x + w, gap.y, gap.w - w, h};
+        above = SDL_Rect{gap.x, gap.y + h, gap.w, gap.h - h};
+    }
+    for (const SDL_Rect& piece : {right, above}) {
+        if (piece.w > 0 && piece.h > 0) {
+            gaps_.push_back(piece);
+        }
+    }
+    return true;
+}
+
+int SkylinePacker::fit(std::size_t index, int w, int h, int& hidden) const {
+    const int left = skyline_[index].x;
+    if (left + w > size_) {
+        return -1;
+    }
+    int y = 0;
+    for (std::size_t i = index; i < skyline_.size() && skyline_[i].x < left + w; ++i) {
+        y = std::max(y, skyline_[i].y);
+    }
+    if (y + h > size_) {
+        return -1;
+    }
+    hidden = 0;
+    for (std::size_t i = index; i < skyline_.size() && skyline_[i].x < left + w; ++i) {
+        const int span = std::min(skyline_[i].x + skyline_[i].w, left + w) - skyline_[i].x;
+        hidden += span * (y - skyline_[i].y);
+    }
+    return y;
+}
+
+void SkylinePacker::place(std::size_t index, const SDL_Rect& rect) {
+    const int right = rect.x + rect.w;
+    // Everything under the new rectangle becomes gaps, and the segments it
+    // covers are cut back to what sticks out past its right edge.
+    std::size_t end = index;
+    for (; end < skyline_.size() && skyline_[end].x < right; ++end) {
+        Segment& segment = skyline_[end];
+        const int span = std::min(segment.x + segment.w, right) - segment.x;
+        if (segment.y < rect.y) {
+            gaps_.push_back(SDL_Rect{segment.x, segment.y, span, rect.y - segment.y});
+        }
+        if (segment.x + segment.w > right) {
+            segment.w -= right - segment.x;
+            segment.x = right;
+            break;
+        }
+    }
+    skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(index), skyline_.begin() + static_cast<std::ptrdiff_t>(end));
+    skyline_.insert(skyline_.begin() + static_cast<std::ptrdiff_t>(index), Segment{rect.x, rect.y + rect.h, rect.w});
+    // Merge neighbours at the same height so the skyline stays short.
+    for (std::size_t i = index > 0 ? index - 1 : 0; i + 1 < skyline_.size() && i <= index + 1;) {
+        if (skyline_[i].y == skyline_[i + 1].y) {
+            skyline_[i].w += skyline_[i + 1].w;
+            skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+        } else {
+            ++i;
+        }
+    }
+}
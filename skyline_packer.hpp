@@ -0,0 +1,47 @@
+
+#pragma once
+
+#include <SDL3/SDL_rect.h>
+
+#include <vector>
+
+// Packs rectangles into a square page along a skyline: the page is
+// described by the top edge of everything placed so far, and each rectangle
+// goes where its top ends up lowest, ties going to the spot that leaves the
+// least area hidden underneath. The gaps a placement leaves below it are
+// kept as free rectangles and filled first, split guillotine-style, so
+// glyphs of very different heights pack densely where a shelf packer would
+// waste the space above every short glyph on a tall shelf.
+class SkylinePacker {
+public:
+    explicit SkylinePacker(int size);
+    // Treats rows above reserved_height as already in use, for pages whose
+    // contents were packed elsewhere and only their used height is known.
+    SkylinePacker(int size, int reserved_height);
+
+    // On success rect is exactly w x h.
+    bool pack(int w, int h, SDL_Rect& rect);
+    void reset();
+
+    int size() const { return size_; }
+    // Height of the highest point of the skyline.
+    int used_height() const;
+
+private:
+    struct Segment {
+        int x;
+        int y;
+        int w;
+    };
+
+    bool pack_gap(int w, int h, SDL_Rect& rect);
+    // y at which a w x h rectangle starting at segment index would sit, or
+    // -1 if it does not fit; hidden receives the area it would leave below.
+    int fit(std::size_t index, int w, int h, int& hidden) const;
+    void place(std::size_t index, const SDL_Rect& rect);
+
+    int size_;
+    int reserved_height_;
+    std::vector<Segment> skyline_;
+    std::vector<SDL_Rect> gaps_;
+};
@@ -0,0 +1,46 @@
+
+#include "subsystems.hpp"
+
+#include "trace.hpp"
+
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_init.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <chrono>
+
+Subsystems::Subsystems()
+    : ttf_(std::async(std::launch::async, [] {
+          TRACE_SCOPE("TTF_Init");
+          if (!TTF_Init()) {
+              SDL_Log("TTF_Init failed: %s", SDL_GetError());
+              return false;
+          }
+          return true;
+      }).share()) {}
+
+Subsystems::~Subsystems() {
+    TRACE_SCOPE("shutdown");
+    if (ttf_.get()) {
+        TTF_Quit();
+    }
+    SDL_Quit();
+}
+
+bool Subsystems::video() {
+    if (!video_tried_) {
+        TRACE_SCOPE("SDL_InitSubSystem(video)");
+        video_tried_ = true;
+        video_ = SDL_InitSubSystem(SDL_INIT_VIDEO);
+    }
+    return video_;
+}
+
+bool Subsystems::ttf() const {
+    if (ttf_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        TRACE_SCOPE("wait_for_ttf");
+        ttf_.wait();
+    }
+    return ttf_.get();
+}
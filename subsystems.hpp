@@ -0,0 +1,39 @@
+
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <future>
+
+// Brings up SDL and SDL_ttf on first use instead of all at once at the top
+// of main(). TTF_Init, which loads FreeType (and HarfBuzz when SDL_ttf is
+// built with it), starts on a background thread as soon as this is
+// constructed, so it overlaps option parsing, video init and window
+// creation; the first font open waits for it through ttf(). Video is only
+// initialized when a window is about to be created, so headless runs never
+// pay for it.
+//
+// Construct one at the start of main(), before anything that might use
+// either library, and destroy it after every font and window is gone.
+class Subsystems {
+public:
+    Subsystems();
+    // Waits for TTF_Init and shuts down whatever was brought up.
+    ~Subsystems();
+
+    Subsystems(const Subsystems&) = delete;
+    Subsystems& operator=(const Subsystems&) = delete;
+
+    // Initializes the video subsystem on first call. Main thread only, as
+    // SDL requires. Returns false with the SDL error set if it failed.
+    bool video();
+
+    // Blocks until TTF_Init has finished. Any thread; returns false if it
+    // failed.
+    bool ttf() const;
+
+private:
+    std::shared_future<bool> ttf_;
+    bool video_tried_ = false;
+    bool video_ = false;
+};
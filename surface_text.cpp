@@ -0,0 +1,238 @@
+
+#include "surface_text.hpp"
+
+#include "blit_kernels.hpp"
+#include "glyph_raster.hpp"
+#include "text_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Clips a w x h source placed at (x, y) against dst. On success src_x/src_y
+// give the first visible source pixel and the rest is the visible area in
+// destination coordinates.
+bool clip(const SDL_Surface* dst, int& x, int& y, int& w, int& h, int& src_x, int& src_y) {
+    src_x = std::max(0, -x);
+    src_y = std::max(0, -y);
+    x += src_x;
+    y += src_y;
+    w = std::min(w - src_x, dst->w - x);
+    h = std::min(h - src_y, dst->h - y);
+    return w > 0 && h > 0;
+}
+
+Uint32* dst_pixel(SDL_Surface* dst, int x, int y) {
+    return reinterpret_cast<Uint32*>(static_cast<Uint8*>(dst->pixels) + y * dst->pitch) + x;
+}
+
+// Bilinear sample of a src_w x src_h bitmap at (x0 + fx, y0 + fy). Checked
+// reads treat everything outside the bitmap as empty; unchecked ones need
+// the whole 2x2 footprint inside it.
+template <bool Checked>
+float sample(const Uint8* pixels, int src_w, int src_h, int x0, int y0, float fx, float fy) {
+    const auto at = [&](int x, int y) -> float {
+        if constexpr (Checked) {
+            if (x < 0 || y < 0 || x >= src_w || y >= src_h) {
+                return 0.0f;
+            }
+        }
+        return pixels[static_cast<std::size_t>(y) * src_w + x];
+    };
+    const float top = at(x0, y0) * (1.0f - fx) + at(x0 + 1, y0) * fx;
+    const float bottom = at(x0, y0 + 1) * (1.0f - fx) + at(x0 + 1, y0 + 1) * fx;
+    return top * (1.0f - fy) + bottom * fy;
+}
+
+// Maps a sample value to output coverage: SDF fields get an antialiased
+// threshold, coverage passes through.
+template <bool Sdf>
+Uint8 shade(float value, float distance_scale) {
+    if constexpr (Sdf) {
+        value = std::clamp((value - 128.0f) * distance_scale + 0.5f, 0.0f, 1.0f) * 255.0f;
+    }
+    return static_cast<Uint8>(value + 0.5f);
+}
+
+// Resamples a coverage bitmap or distance field into out, w x h. Sdf is a
+// template parameter so the per-pixel loop has no mode branch, and the
+// columns whose samples lie wholly inside the source skip bounds checks,
+// leaving the interior loop straight-line for the vectorizer.
+template <bool Sdf>
+void resample_coverage(const Uint8* pixels, int src_w, int src_h, float scale, float phase_x, float phase_y, int w, int h, Uint8* out) {
+    // An SDF step of 128 / sdf_spread is one source pixel, and one source
+    // pixel covers scale destination pixels; a ramp one destination pixel
+    // wide centred on the outline antialiases the edge.
+    const float distance_scale = static_cast<float>(sdf_spread) * scale / 128.0f;
+    const auto source_x = [&](int col) { return (static_cast<float>(col) + 0.5f - phase_x) / scale - 0.5f; };
+    const auto floor_int = [](float v) { return static_cast<int>(std::floor(v)); };
+    // u grows with col, so the unchecked columns are one contiguous span.
+    int col_begin = 0;
+    while (col_begin < w && floor_int(source_x(col_begin)) < 0) {
+        ++col_begin;
+    }
+    int col_end = w;
+    while (col_end > col_begin && floor_int(source_x(col_end - 1)) + 1 >= src_w) {
+        --col_end;
+    }
+    for (int row = 0; row < h; ++row) {
+        const float v = (static_cast<float>(row) + 0.5f - phase_y) / scale - 0.5f;
+        const int y0 = floor_int(v);
+        const float fy = v - static_cast<float>(y0);
+        Uint8* line = out + static_cast<std::size_t>(row) * w;
+        const bool row_inside = y0 >= 0 && y0 + 1 < src_h;
+        const int fast_begin = row_inside ? col_begin : w;
+        const int fast_end = row_inside ? col_end : w;
+        const auto checked = [&](int col) {
+            const float u = source_x(col);
+            const int x0 = floor_int(u);
+            line[col] = shade<Sdf>(sample<true>(pixels, src_w, src_h, x0, y0, u - static_cast<float>(x0), fy), distance_scale);
+        };
+        for (int col = 0; col < fast_begin; ++col) {
+            checked(col);
+        }
+        for (int col = fast_begin; col < fast_end; ++col) {
+            const float u = source_x(col);
+            const int x0 = floor_int(u);
+            line[col] = shade<Sdf>(sample<false>(pixels, src_w, src_h, x0, y0, u - static_cast<float>(x0), fy), distance_scale);
+        }
+        for (int col = std::max(fast_begin, fast_end); col < w; ++col) {
+            checked(col);
+        }
+    }
+}
+
+} // namespace
+
+bool blit_tinted(SDL_Surface* dst, const SDL_Surface* src, int x, int y, SDL_Color tint) {
+    if (dst->format != SDL_PIXELFORMAT_ARGB8888 || src->format != SDL_PIXELFORMAT_ARGB8888) {
+        return false;
+    }
+    int w = src->w;
+    int h = src->h;
+    int src_x = 0;
+    int src_y = 0;
+    if (!clip(dst, x, y, w, h, src_x, src_y)) {
+        return true;
+    }
+    const auto* src_pixels = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(src->pixels) + src_y * src->pitch) + src_x;
+    blit_kernels().argb(src_pixels, src->pitch, dst_pixel(dst, x, y), dst->pitch, w, h, tint);
+    return true;
+}
+
+SurfaceTextRenderer::SurfaceTextRenderer(ShapedRunCache& runs)
+    : SurfaceTextRenderer(runs, Config{}) {}
+
+SurfaceTextRenderer::SurfaceTextRenderer(ShapedRunCache& runs, Config config)
+    : runs_(runs), config_(config) {}
+
+bool SurfaceTextRenderer::draw(SDL_Surface* dst, TTF_Font* font, std::string_view text, int x, int y, SDL_Color color) {
+    if (dst->format != SDL_PIXELFORMAT_ARGB8888) {
+        return false;
+    }
+    const ShapedRun* run = runs_.shape(font, text);
+    if (run == nullptr) {
+        return false;
+    }
+    const BlitKernels& kernels = blit_kernels();
+    for (const ShapedGlyph& shaped : run->glyphs) {
+        const CoverageGlyph* glyph = lookup(font, shaped.codepoint);
+        if (glyph == nullptr || glyph->w == 0) {
+            continue;
+        }
+        int glyph_x = x + static_cast<int>(shaped.x) + glyph->offset_x;
+        int glyph_y = y + static_cast<int>(shaped.y) + glyph->offset_y;
+        int w = glyph->w;
+        int h = glyph->h;
+        int src_x = 0;
+        int src_y = 0;
+        if (!clip(dst, glyph_x, glyph_y, w, h, src_x, src_y)) {
+            continue;
+        }
+        kernels.coverage(glyph->pixels.data() + src_y * glyph->w + src_x, glyph->w, dst_pixel(dst, glyph_x, glyph_y), dst->pitch, w, h, color);
+    }
+    return true;
+}
+
+bool SurfaceTextRenderer::draw_scaled(SDL_Surface* dst, TTF_Font* font, float size, std::string_view text, float x, float y, SDL_Color color) {
+    if (dst->format != SDL_PIXELFORMAT_ARGB8888) {
+        return false;
+    }
+    const ShapedRun* run = runs_.shape(font, text);
+    if (run == nullptr) {
+        return false;
+    }
+    const float scale = size / TTF_GetFontSize(font);
+    const bool sdf = TTF_GetFontSDF(font);
+    const BlitKernels& kernels = blit_kernels();
+    for (const ShapedGlyph& shaped : run->glyphs) {
+        const CoverageGlyph* glyph = lookup(font, shaped.codepoint);
+        if (glyph == nullptr || glyph->w == 0) {
+            continue;
+        }
+        const float left = x + (shaped.x + static_cast<float>(glyph->offset_x)) * scale;
+        const float top = y + (shaped.y + static_cast<float>(glyph->offset_y)) * scale;
+        int glyph_x = static_cast<int>(std::floor(left));
+        int glyph_y = static_cast<int>(std::floor(top));
+        const float phase_x = left - static_cast<float>(glyph_x);
+        const float phase_y = top - static_cast<float>(glyph_y);
+        const int scaled_w = static_cast<int>(std::ceil(static_cast<float>(glyph->w) * scale + phase_x));
+        const int scaled_h = static_cast<int>(std::ceil(static_cast<float>(glyph->h) * scale + phase_y));
+        int w = scaled_w;
+        int h = scaled_h;
+        int src_x = 0;
+        int src_y = 0;
+        if (!clip(dst, glyph_x, glyph_y, w, h, src_x, src_y)) {
+            continue;
+        }
+        resample(*glyph, scale, phase_x, phase_y, scaled_w, scaled_h, sdf);
+        kernels.coverage(scaled_.data() + src_y * scaled_w + src_x, scaled_w, dst_pixel(dst, glyph_x, glyph_y), dst->pitch, w, h, color);
+    }
+    return true;
+}
+
+// Fills scaled_ with a w x h coverage image of glyph drawn at scale, offset
+// by a subpixel phase, sampling the source bilinearly at pixel centres.
+void SurfaceTextRenderer::resample(const CoverageGlyph& glyph, float scale, float phase_x, float phase_y, int w, int h, bool sdf) {
+    scaled_.resize(static_cast<std::size_t>(w) * h);
+    if (sdf) {
+        resample_coverage<true>(glyph.pixels.data(), glyph.w, glyph.h, scale, phase_x, phase_y, w, h, scaled_.data());
+    } else {
+        resample_coverage<false>(glyph.pixels.data(), glyph.w, glyph.h, scale, phase_x, phase_y, w, h, scaled_.data());
+    }
+}
+
+const SurfaceTextRenderer::CoverageGlyph* SurfaceTextRenderer::lookup(TTF_Font* font, Uint32 codepoint) {
+    const GlyphKey key = GlyphKey::of(font, codepoint, GlyphRenderMode::blended);
+    if (const auto it = glyphs_.find(key); it != glyphs_.end()) {
+        ++text_stats().glyph_hits;
+        return &it->second;
+    }
+    ++text_stats().glyph_misses;
+    GlyphBitmap bitmap;
+    if (!rasterize_glyph(font, codepoint, bitmap)) {
+        return nullptr;
+    }
+    if (glyphs_.size() >= config_.max_glyphs) {
+        glyphs_.clear();
+    }
+    CoverageGlyph& glyph = glyphs_[key];
+    if (bitmap.surface != nullptr) {
+        const SDL_Rect& ink = bitmap.ink;
+        glyph.w = ink.w;
+        glyph.h = ink.h;
+        glyph.offset_x = ink.x;
+        glyph.offset_y = ink.y;
+        glyph.pixels.resize(static_cast<std::size_t>(ink.w) * ink.h);
+        for (int row = 0; row < ink.h; ++row) {
+            const auto* src = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(bitmap.surface->pixels) + (ink.y + row) * bitmap.surface->pitch) + ink.x;
+            Uint8* out = glyph.pixels.data() + static_cast<std::size_t>(row) * ink.w;
+            for (int col = 0; col < ink.w; ++col) {
+                out[col] = static_cast<Uint8>(src[col] >> 24);
+            }
+        }
+        SDL_DestroySurface(bitmap.surface);
+    }
+    return &glyph;
+}
@@ -0,0 +1,65 @@
+
+#pragma once
+
+#include "glyph_atlas.hpp"
+#include "shaped_run_cache.hpp"
+
+#include <SDL3/SDL_surface.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Composites an ARGB8888 surface, such as TTF_RenderText_Blended output,
+// onto an ARGB8888 destination at (x, y), tinted and clipped to the
+// destination, using the fastest blit kernels available.
+bool blit_tinted(SDL_Surface* dst, const SDL_Surface* src, int x, int y, SDL_Color tint);
+
+// Draws text straight into ARGB8888 surfaces on the CPU, for headless and
+// server-side label rendering where there is no GPU to hold an atlas.
+// Glyphs are cached as 8-bit coverage, a quarter of the bytes of the ARGB
+// bitmaps SDL3_ttf produces, and blended with the SIMD kernels in
+// blit_kernels.hpp.
+class SurfaceTextRenderer {
+public:
+    struct Config {
+        // The cache is dropped wholesale past this many glyphs.
+        std::size_t max_glyphs = 8192;
+    };
+
+    explicit SurfaceTextRenderer(ShapedRunCache& runs);
+    SurfaceTextRenderer(ShapedRunCache& runs, Config config);
+
+    // Draws text with its top-left corner at (x, y). Returns false if dst is
+    // not ARGB8888 or the text could not be shaped.
+    bool draw(SDL_Surface* dst, TTF_Font* font, std::string_view text, int x, int y, SDL_Color color);
+
+    // Draws text at size by resampling the glyphs and layout the font has at
+    // its own size. For fonts from FontManager::open_sdf() every pixel is
+    // thresholded against the distance field, which keeps edges sharp and
+    // about one pixel wide at any scale; other fonts are filtered bilinearly.
+    bool draw_scaled(SDL_Surface* dst, TTF_Font* font, float size, std::string_view text, float x, float y, SDL_Color color);
+
+    void clear() { glyphs_.clear(); }
+    std::size_t glyph_count() const { return glyphs_.size(); }
+
+private:
+    struct CoverageGlyph {
+        std::vector<Uint8> pixels;
+        int w = 0;
+        int h = 0;
+        int offset_x = 0;
+        int offset_y = 0;
+    };
+
+    const CoverageGlyph* lookup(TTF_Font* font, Uint32 codepoint);
+    void resample(const CoverageGlyph& glyph, float scale, float phase_x, float phase_y, int w, int h, bool sdf);
+
+    ShapedRunCache& runs_;
+    Config config_;
+    std::unordered_map<GlyphKey, CoverageGlyph, GlyphKeyHash> glyphs_;
+    // Coverage of the glyph draw_scaled() is blending, reused between glyphs.
+    std::vector<Uint8> scaled_;
+};
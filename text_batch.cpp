@@ -0,0 +1,76 @@
+
+#include "text_batch.hpp"
+
+#include "text_stats.hpp"
+
+TextBatch::TextBatch(GlyphAtlas& atlas, ShapedRunCache& runs)
+    : atlas_(atlas), runs_(runs) {}
+
+void TextBatch::clear() {
+    for (auto& vertices : page_vertices_) {
+        vertices.clear();
+    }
+}
+
+float TextBatch::add(TTF_Font* font, std::string_view text, float x, float y, SDL_FColor color) {
+    return add_scaled(font, TTF_GetFontSize(font), text, x, y, color);
+}
+
+float TextBatch::add_scaled(TTF_Font* font, float size, std::string_view text, float x, float y, SDL_FColor color) {
+    const float scale = size / TTF_GetFontSize(font);
+    const ShapedRun* run = runs_.shape(font, text);
+    if (run == nullptr) {
+        return x;
+    }
+    if (scale == 1.0f) {
+        add_run<false>(font, *run, x, y, color, scale);
+    } else {
+        add_run<true>(font, *run, x, y, color, scale);
+    }
+    return x + static_cast<float>(run->width) * scale;
+}
+
+template <bool Scaled>
+void TextBatch::add_run(TTF_Font* font, const ShapedRun& run, float x, float y, SDL_FColor color, float scale) {
+    for (const ShapedGlyph& shaped : run.glyphs) {
+        const Glyph* glyph = atlas_.lookup(font, shaped.codepoint);
+        if (glyph == nullptr || glyph->page < 0) {
+            continue;
+        }
+        if (page_vertices_.size() <= static_cast<std::size_t>(glyph->page)) {
+            page_vertices_.resize(glyph->page + 1);
+        }
+        if constexpr (Scaled) {
+            append_glyph_quad<true>(page_vertices_[glyph->page], *glyph, x + shaped.x * scale, y + shaped.y * scale, color, scale);
+        } else {
+            append_glyph_quad<false>(page_vertices_[glyph->page], *glyph, x + shaped.x, y + shaped.y, color, scale);
+        }
+    }
+}
+
+int TextBatch::flush() {
+    atlas_.flush_uploads();
+    int draw_calls = 0;
+    for (std::size_t page = 0; page < page_vertices_.size(); ++page) {
+        auto& vertices = page_vertices_[page];
+        if (vertices.empty()) {
+            continue;
+        }
+        const std::size_t quads = vertices.size() / 4;
+        ensure_quad_indices(indices_, quads);
+        SDL_RenderGeometry(atlas_.renderer(), atlas_.page_texture(static_cast<int>(page)), vertices.data(), static_cast<int>(vertices.size()), indices_.data(), static_cast<int>(quads * 6));
+        text_stats().vertices += vertices.size();
+        vertices.clear();
+        ++draw_calls;
+    }
+    text_stats().draw_calls += static_cast<Uint64>(draw_calls);
+    return draw_calls;
+}
+
+std::size_t TextBatch::quad_count() const {
+    std::size_t quads = 0;
+    for (const auto& vertices : page_vertices_) {
+        quads += vertices.size() / 4;
+    }
+    return quads;
+}
@@ -0,0 +1,53 @@
+
+#pragma once
+
+#include "glyph_atlas.hpp"
+#include "shaped_run_cache.hpp"
+
+#include <SDL3/SDL_render.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Collects every string queued during a frame and submits them with one
+// SDL_RenderGeometry call per atlas page. Vertex and index storage is kept
+// between frames, so once the largest frame has been seen no further
+// allocation happens.
+//
+// Glyphs are looked up as strings are added, so call GlyphAtlas::begin_frame()
+// before the first add() of a frame and flush() before the next begin_frame().
+class TextBatch {
+public:
+    TextBatch(GlyphAtlas& atlas, ShapedRunCache& runs);
+
+    // Drops everything queued since the last flush while keeping capacity.
+    void clear();
+
+    // Queues UTF-8 text with its top-left corner at (x, y). Returns the x
+    // coordinate just past the text's bounding box.
+    float add(TTF_Font* font, std::string_view text, float x, float y, SDL_FColor color);
+
+    // Like add(), but draws the text at size by scaling the glyphs and layout
+    // the font has at its own size, so any number of sizes share one set of
+    // atlas entries. SDL_Renderer has no programmable pass to threshold a
+    // distance field, so fonts from FontManager::open_sdf() come out as soft
+    // halos here; draw those with SurfaceTextRenderer::draw_scaled() or
+    // GpuTextRenderer instead.
+    float add_scaled(TTF_Font* font, float size, std::string_view text, float x, float y, SDL_FColor color);
+
+    // Submits and clears the queued quads. Returns the number of draw calls.
+    int flush();
+
+    std::size_t quad_count() const;
+
+private:
+    template <bool Scaled>
+    void add_run(TTF_Font* font, const ShapedRun& run, float x, float y, SDL_FColor color, float scale);
+
+    GlyphAtlas& atlas_;
+    ShapedRunCache& runs_;
+    std::vector<std::vector<SDL_Vertex>> page_vertices_;
+    std::vector<int> indices_;
+};
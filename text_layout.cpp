@@ -0,0 +1,155 @@
+
+#include "text_layout.hpp"
+
+#include "text_stats.hpp"
+#include "trace.hpp"
+
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+#include <cmath>
+
+TextLayout::TextLayout(TTF_TextEngine* engine, TTF_Font* font, int wrap_width)
+    : TextLayout(engine, font, wrap_width, Config{}) {}
+
+TextLayout::TextLayout(TTF_TextEngine* engine, TTF_Font* font, int wrap_width, Config config)
+    : engine_(engine), font_(font), wrap_width_(wrap_width), config_(config), font_generation_(TTF_GetFontGeneration(font)) {}
+
+TextLayout::~TextLayout() {
+    clear();
+}
+
+void TextLayout::append(std::string_view text) {
+    if (paragraphs_.empty()) {
+        paragraphs_.emplace_back();
+        heights_.push_back(line_height());
+    }
+    for (;;) {
+        const std::size_t newline = text.find('\n');
+        Paragraph& last = paragraphs_.back();
+        last.text.append(text.substr(0, newline));
+        if (newline != 0) {
+            last.dirty = true;
+        }
+        if (newline == std::string_view::npos) {
+            return;
+        }
+        text.remove_prefix(newline + 1);
+        paragraphs_.emplace_back();
+        heights_.push_back(line_height());
+    }
+}
+
+void TextLayout::set_paragraph(std::size_t index, std::string_view text) {
+    Paragraph& paragraph = paragraphs_[index];
+    paragraph.text.assign(text);
+    paragraph.dirty = true;
+}
+
+void TextLayout::set_wrap_width(int wrap_width) {
+    if (wrap_width != wrap_width_) {
+        wrap_width_ = wrap_width;
+        invalidate_all();
+    }
+}
+
+void TextLayout::clear() {
+    for (Paragraph& paragraph : paragraphs_) {
+        destroy_text(paragraph.text_object);
+    }
+    paragraphs_.clear();
+    heights_.clear();
+    live_.clear();
+    visible_.clear();
+}
+
+const std::vector<TextLayout::VisibleParagraph>& TextLayout::layout_visible(float scroll_y, float viewport_h) {
+    TRACE_SCOPE("TextLayout::layout_visible");
+    if (const Uint32 generation = TTF_GetFontGeneration(font_); generation != font_generation_) {
+        font_generation_ = generation;
+        invalidate_all();
+    }
+    ++pass_;
+    visible_.clear();
+    const auto top = static_cast<std::int64_t>(std::floor(std::max(scroll_y, 0.0f)));
+    const auto bottom = static_cast<std::int64_t>(std::ceil(scroll_y + viewport_h));
+    std::size_t index = heights_.find(top);
+    std::int64_t y = heights_.prefix(index);
+    for (; index < paragraphs_.size() && y < bottom; ++index) {
+        Paragraph& paragraph = paragraphs_[index];
+        if (paragraph.dirty || paragraph.text_object == nullptr) {
+            lay_out(index);
+        }
+        paragraph.used_pass = pass_;
+        if (paragraph.text_object != nullptr) {
+            visible_.push_back(VisibleParagraph{index, paragraph.text_object, static_cast<float>(y)});
+        }
+        y += heights_.height(index);
+    }
+    release_texts();
+    return visible_;
+}
+
+void TextLayout::draw_renderer(float x, float y, float scroll_y, float viewport_h) {
+    for (const VisibleParagraph& visible : layout_visible(scroll_y, viewport_h)) {
+        TTF_DrawRendererText(visible.text, x, y + visible.y - scroll_y);
+    }
+}
+
+void TextLayout::invalidate_all() {
+    heights_.clear();
+    const int estimate = line_height();
+    for (Paragraph& paragraph : paragraphs_) {
+        paragraph.dirty = true;
+        heights_.push_back(estimate);
+    }
+}
+
+void TextLayout::lay_out(std::size_t index) {
+    TtfTimer timer;
+    Paragraph& paragraph = paragraphs_[index];
+    if (paragraph.text_object == nullptr) {
+        paragraph.text_object = config_.pool != nullptr ? config_.pool->acquire(font_, paragraph.text) : TTF_CreateText(engine_, font_, paragraph.text.data(), paragraph.text.size());
+        if (paragraph.text_object == nullptr) {
+            SDL_Log("TextLayout: failed to lay out paragraph %zu: %s", index, SDL_GetError());
+            return;
+        }
+        live_.push_back(index);
+    } else {
+        TTF_SetTextString(paragraph.text_object, paragraph.text.data(), paragraph.text.size());
+    }
+    TTF_SetTextWrapWidth(paragraph.text_object, wrap_width_);
+    paragraph.dirty = false;
+    int w = 0;
+    int h = 0;
+    TTF_GetTextSize(paragraph.text_object, &w, &h);
+    heights_.set(index, std::max(h, line_height()));
+}
+
+void TextLayout::release_texts() {
+    // live_ is in creation order, so paragraphs drawn this pass are rotated
+    // to the back rather than released.
+    for (std::size_t checked = live_.size(); live_.size() > config_.max_live_texts && checked > 0; --checked) {
+        const std::size_t index = live_.front();
+        live_.pop_front();
+        Paragraph& paragraph = paragraphs_[index];
+        if (paragraph.used_pass == pass_) {
+            live_.push_back(index);
+            continue;
+        }
+        destroy_text(paragraph.text_object);
+        paragraph.text_object = nullptr;
+    }
+}
+
+void TextLayout::destroy_text(TTF_Text* text) {
+    if (config_.pool != nullptr) {
+        config_.pool->release(text);
+    } else if (text != nullptr) {
+        TTF_DestroyText(text);
+    }
+}
+
+int TextLayout::line_height() const {
+    return std::max(TTF_GetFontLineSkip(font_), 1);
+}
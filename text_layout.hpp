@@ -0,0 +1,108 @@
+
+#pragma once
+
+#include "height_index.hpp"
+#include "text_pool.hpp"
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Soft-wrapped layout of a long, growing text buffer such as a log or chat
+// pane. The buffer is split into paragraphs at '\n', and each paragraph is
+// laid out by its own TTF_Text, which keeps that paragraph's line breaks
+// and glyph positions. Editing or appending only re-lays out the
+// paragraphs that changed.
+//
+// Only paragraphs that have been scrolled into view are laid out at all;
+// the rest count as one line until they are. Paragraph heights live in a
+// HeightIndex, so finding what is visible costs O(log n + visible
+// paragraphs) however long the buffer grows. At most max_live_texts
+// TTF_Text objects are kept; paragraphs that scroll far out of view drop
+// theirs and keep only their measured height.
+//
+// A change to the font's size or style (TTF_GetFontGeneration) or to the
+// wrap width invalidates every paragraph's layout.
+class TextLayout {
+public:
+    struct Config {
+        std::size_t max_live_texts = 1024;
+        // When set, texts come from and go back to this pool, which must
+        // be for the layout's engine and outlive it.
+        TextPool* pool = nullptr;
+    };
+
+    struct VisibleParagraph {
+        std::size_t index;
+        TTF_Text* text;
+        // Top of the paragraph relative to the top of the buffer.
+        float y;
+    };
+
+    // engine and font must outlive the layout. A wrap_width of 0 wraps only
+    // at newlines.
+    TextLayout(TTF_TextEngine* engine, TTF_Font* font, int wrap_width);
+    TextLayout(TTF_TextEngine* engine, TTF_Font* font, int wrap_width, Config config);
+    ~TextLayout();
+
+    TextLayout(const TextLayout&) = delete;
+    TextLayout& operator=(const TextLayout&) = delete;
+
+    // Appends UTF-8 text. Text before the first '\n' continues the last
+    // paragraph, every '\n' starts a new one.
+    void append(std::string_view text);
+
+    // Replaces one paragraph, which must not contain '\n'.
+    void set_paragraph(std::size_t index, std::string_view text);
+
+    void set_wrap_width(int wrap_width);
+    void clear();
+
+    std::size_t paragraph_count() const { return paragraphs_.size(); }
+    std::string_view paragraph(std::size_t index) const { return paragraphs_[index].text; }
+
+    // Height of the whole buffer, counting paragraphs not yet laid out as
+    // one line each. Grows towards the true height as more is seen.
+    std::int64_t content_height() const { return heights_.total(); }
+
+    // Lays out the paragraphs intersecting [scroll_y, scroll_y + viewport_h)
+    // and returns them top to bottom. The result and its TTF_Text pointers
+    // are valid until the next call that modifies the layout.
+    const std::vector<VisibleParagraph>& layout_visible(float scroll_y, float viewport_h);
+
+    // Draws the visible paragraphs with TTF_DrawRendererText, with the top
+    // of the viewport at (x, y). engine must be a renderer text engine.
+    void draw_renderer(float x, float y, float scroll_y, float viewport_h);
+
+private:
+    struct Paragraph {
+        std::string text;
+        TTF_Text* text_object = nullptr;
+        // The TTF_Text no longer matches text, font or wrap width.
+        bool dirty = true;
+        Uint64 used_pass = 0;
+    };
+
+    void invalidate_all();
+    void lay_out(std::size_t index);
+    void release_texts();
+    void destroy_text(TTF_Text* text);
+    int line_height() const;
+
+    TTF_TextEngine* engine_;
+    TTF_Font* font_;
+    int wrap_width_;
+    Config config_;
+    Uint32 font_generation_;
+    std::vector<Paragraph> paragraphs_;
+    HeightIndex heights_;
+    // Paragraphs holding a TTF_Text, oldest first.
+    std::deque<std::size_t> live_;
+    Uint64 pass_ = 0;
+    std::vector<VisibleParagraph> visible_;
+};
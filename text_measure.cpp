@@ -0,0 +1,239 @@
+
+#include "text_measure.hpp"
+
+#include "frame_arena.hpp"
+#include "text_stats.hpp"
+#include "trace.hpp"
+#include "utf8.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t';
+}
+
+bool measure(TTF_Font* font, std::string_view text, int& width) {
+    width = 0;
+    if (text.empty()) {
+        return true;
+    }
+    int height = 0;
+    return TTF_GetStringSize(font, text.data(), text.size(), &width, &height);
+}
+
+} // namespace
+
+std::size_t TextMeasureCache::KeyHash::operator()(const KeyView& key) const noexcept {
+    std::size_t h = std::hash<std::string_view>{}(key.text);
+    h ^= std::hash<const void*>{}(key.font) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= std::hash<float>{}(key.size) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= std::hash<int>{}(static_cast<int>(key.hinting)) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+TextMeasureCache::TextMeasureCache()
+    : TextMeasureCache(Config{}) {}
+
+TextMeasureCache::TextMeasureCache(Config config)
+    : config_(config) {}
+
+bool TextMeasureCache::wrapped_size(TTF_Font* font, std::string_view text, int wrap_width, WrappedSize& size) {
+    Entry* entry = find(font, text);
+    if (entry == nullptr) {
+        return false;
+    }
+    wrap_width = std::max(wrap_width, 0);
+    if (entry->last_wrap_width == wrap_width) {
+        size = entry->last_size;
+        return true;
+    }
+    WrappedSize result;
+    if (wrap_width == 0 || wrap_width >= entry->max_width) {
+        result.width = entry->max_width;
+        result.lines = static_cast<int>(entry->paragraphs.size()) - 1;
+    } else {
+        const Word* words = entry->words.data();
+        for (std::size_t p = 0; p + 1 < entry->paragraphs.size(); ++p) {
+            std::size_t i = entry->paragraphs[p];
+            const std::size_t last = entry->paragraphs[p + 1];
+            if (i == last) {
+                ++result.lines;
+            }
+            while (i < last) {
+                // The first word that would end past the wrap width starts
+                // the next line.
+                const int limit = words[i].start + wrap_width;
+                const Word* next = std::upper_bound(words + i, words + last, limit, [](int value, const Word& word) { return value < word.end; });
+                const auto j = static_cast<std::size_t>(next - words);
+                if (j == i) {
+                    const std::string_view word = text.substr(words[i].offset, words[i].length);
+                    result.lines += split_lines(font, word, wrap_width, result.width);
+                    ++i;
+                    continue;
+                }
+                result.width = std::max(result.width, words[j - 1].end - words[i].start);
+                ++result.lines;
+                i = j;
+            }
+        }
+    }
+    result.height = result.lines * entry->line_skip;
+    entry->last_wrap_width = wrap_width;
+    entry->last_size = result;
+    size = result;
+    return true;
+}
+
+bool TextMeasureCache::content_widths(TTF_Font* font, std::string_view text, int& min_width, int& max_width) {
+    const Entry* entry = find(font, text);
+    if (entry == nullptr) {
+        return false;
+    }
+    min_width = entry->min_width;
+    max_width = entry->max_width;
+    return true;
+}
+
+void TextMeasureCache::forget(TTF_Font* font) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        const auto next = std::next(it);
+        if (it->first.font == font) {
+            erase(it);
+        }
+        it = next;
+    }
+    fonts_.erase(font);
+}
+
+void TextMeasureCache::clear() {
+    entries_.clear();
+    lru_.clear();
+    fonts_.clear();
+    bytes_ = 0;
+}
+
+void TextMeasureCache::set_memory_limit(std::size_t bytes) {
+    config_.max_bytes = bytes;
+    trim();
+}
+
+Uint32 TextMeasureCache::epoch_for(TTF_Font* font) {
+    const Uint32 generation = TTF_GetFontGeneration(font);
+    auto [it, inserted] = fonts_.try_emplace(font);
+    FontState& state = it->second;
+    if (inserted) {
+        state = FontState{generation, TTF_GetFontStyle(font), TTF_GetFontOutline(font), 0};
+    } else if (state.generation != generation) {
+        const TTF_FontStyleFlags style = TTF_GetFontStyle(font);
+        const int outline = TTF_GetFontOutline(font);
+        if (style != state.style || outline != state.outline) {
+            ++state.epoch;
+        }
+        state = FontState{generation, style, outline, state.epoch};
+    }
+    return state.epoch;
+}
+
+TextMeasureCache::Entry* TextMeasureCache::find(TTF_Font* font, std::string_view text) {
+    const Uint32 epoch = epoch_for(font);
+    const KeyView probe{font, TTF_GetFontSize(font), TTF_GetFontHinting(font), text};
+    auto it = entries_.find(probe);
+    if (it != entries_.end()) {
+        if (it->second.epoch == epoch) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return &it->second;
+        }
+        erase(it);
+    }
+    Entry entry;
+    if (!build(font, text, entry)) {
+        return nullptr;
+    }
+    entry.epoch = epoch;
+    entry.bytes = sizeof(Key) + sizeof(Entry) + text.size() + entry.words.capacity() * sizeof(Word) + entry.paragraphs.capacity() * sizeof(Uint32);
+    bytes_ += entry.bytes;
+    it = entries_.emplace(Key{font, probe.size, probe.hinting, std::string(text)}, std::move(entry)).first;
+    lru_.push_front(&it->first);
+    it->second.lru = lru_.begin();
+    trim();
+    return &it->second;
+}
+
+bool TextMeasureCache::build(TTF_Font* font, std::string_view text, Entry& entry) {
+    TRACE_SCOPE("TextMeasureCache::build");
+    TtfTimer timer;
+    // Collect into frame scratch and copy the exact counts into the entry,
+    // so cached entries carry no spare capacity.
+    const FrameArena::Scope scratch(frame_arena());
+    ScratchVector<Word> words = make_scratch_vector<Word>();
+    ScratchVector<Uint32> paragraphs = make_scratch_vector<Uint32>();
+    entry.line_skip = TTF_GetFontLineSkip(font);
+    paragraphs.push_back(0);
+    int x = 0;
+    for (std::size_t pos = 0;;) {
+        if (pos == text.size() || text[pos] == '\n') {
+            if (words.size() > paragraphs.back()) {
+                entry.max_width = std::max(entry.max_width, words.back().end);
+            }
+            paragraphs.push_back(static_cast<Uint32>(words.size()));
+            if (pos == text.size()) {
+                entry.words.assign(words.begin(), words.end());
+                entry.paragraphs.assign(paragraphs.begin(), paragraphs.end());
+                return true;
+            }
+            ++pos;
+            x = 0;
+            continue;
+        }
+        const std::size_t word_begin = pos;
+        while (pos < text.size() && text[pos] != '\n' && !is_space(text[pos])) {
+            ++pos;
+        }
+        const std::size_t word_end = pos;
+        while (pos < text.size() && is_space(text[pos])) {
+            ++pos;
+        }
+        int word_width = 0;
+        int space_width = 0;
+        if (!measure(font, text.substr(word_begin, word_end - word_begin), word_width) || !measure(font, text.substr(word_end, pos - word_end), space_width)) {
+            return false;
+        }
+        words.push_back(Word{x, x + word_width, static_cast<Uint32>(word_begin), static_cast<Uint32>(word_end - word_begin)});
+        entry.min_width = std::max(entry.min_width, word_width);
+        x += word_width + space_width;
+    }
+}
+
+int TextMeasureCache::split_lines(TTF_Font* font, std::string_view word, int wrap_width, int& widest) {
+    TtfTimer timer;
+    int lines = 0;
+    while (!word.empty()) {
+        int width = 0;
+        std::size_t length = 0;
+        TTF_MeasureString(font, word.data(), word.size(), wrap_width, &width, &length);
+        // Every line holds at least one character, however narrow the box.
+        if (length == 0) {
+            utf8_next(word, length);
+            measure(font, word.substr(0, length), width);
+        }
+        widest = std::max(widest, width);
+        word.remove_prefix(length);
+        ++lines;
+    }
+    return lines;
+}
+
+void TextMeasureCache::erase(Map::iterator it) {
+    bytes_ -= it->second.bytes;
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+void TextMeasureCache::trim() {
+    while (bytes_ > config_.max_bytes && lru_.size() > 1) {
+        erase(entries_.find(*lru_.back()));
+    }
+}
@@ -0,0 +1,148 @@
+
+#pragma once
+
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct WrappedSize {
+    int width = 0;
+    int height = 0;
+    int lines = 0;
+};
+
+// Answers wrapped-size queries for strings that a layout pass measures over
+// and over at different widths, as flexbox-style layout does when it
+// narrows boxes down to fit.
+//
+// The first query for a (font, text) pair measures every word and every
+// run of whitespace once and keeps their running widths. A query at some
+// width then walks the lines greedily, finding each line's last word by
+// binary search over those widths, so it costs O(lines * log words) with
+// no TTF calls. Only a word wider than the wrap width, which SDL_ttf
+// splits between characters, is measured again.
+//
+// Words are measured on their own, so kerning across a space is not
+// counted and widths can be a pixel or so off TTF_GetStringSizeWrapped()
+// for fonts that kern spaces. Lines break at spaces, tabs and '\n'.
+//
+// Entries are keyed by (font, size, hinting, text), like ShapedRunCache,
+// so a face shared by several sizes or switched between quality tiers
+// keeps an entry for each. They are rebuilt when TTF_GetFontGeneration()
+// reports a style or outline change. The least recently used are dropped
+// once max_bytes is exceeded.
+class TextMeasureCache {
+public:
+    struct Config {
+        std::size_t max_bytes = 1024 * 1024;
+    };
+
+    TextMeasureCache();
+    explicit TextMeasureCache(Config config);
+
+    // Size of text wrapped at wrap_width, which wraps only at newlines when
+    // 0. Returns false only if the font cannot measure the text.
+    bool wrapped_size(TTF_Font* font, std::string_view text, int wrap_width, WrappedSize& size);
+
+    // The widest word (the narrowest box the text fits without splitting
+    // words) and the widest paragraph (the width at which it wraps only at
+    // newlines).
+    bool content_widths(TTF_Font* font, std::string_view text, int& min_width, int& max_width);
+
+    // Drops every entry measured with the font, e.g. from a
+    // FontManager::on_close() listener.
+    void forget(TTF_Font* font);
+    void clear();
+
+    // Lowers or raises max_bytes, dropping entries at once if over it.
+    void set_memory_limit(std::size_t bytes);
+
+    std::size_t memory_used() const { return bytes_; }
+    std::size_t entry_count() const { return entries_.size(); }
+
+private:
+    struct Key {
+        TTF_Font* font;
+        float size;
+        TTF_HintingFlags hinting;
+        std::string text;
+    };
+
+    struct KeyView {
+        TTF_Font* font;
+        float size;
+        TTF_HintingFlags hinting;
+        std::string_view text;
+    };
+
+    struct KeyHash {
+        using is_transparent = void;
+        std::size_t operator()(const KeyView& key) const noexcept;
+        std::size_t operator()(const Key& key) const noexcept { return (*this)(KeyView{key.font, key.size, key.hinting, key.text}); }
+    };
+
+    struct KeyEqual {
+        using is_transparent = void;
+        static KeyView view(const Key& key) { return KeyView{key.font, key.size, key.hinting, key.text}; }
+        static KeyView view(const KeyView& key) { return key; }
+        template <typename A, typename B>
+        bool operator()(const A& a, const B& b) const noexcept {
+            const KeyView x = view(a);
+            const KeyView y = view(b);
+            return x.font == y.font && x.size == y.size && x.hinting == y.hinting && x.text == y.text;
+        }
+    };
+
+    // A word and the whitespace after it. start and end are pen positions
+    // from the start of the paragraph, before the word and after it; a
+    // line from word i to word j is end[j] - start[i] wide.
+    struct Word {
+        int start;
+        int end;
+        Uint32 offset;
+        Uint32 length;
+    };
+
+    struct Entry {
+        // Words of every paragraph, with paragraph p's words in
+        // [paragraphs[p], paragraphs[p + 1]).
+        std::vector<Word> words;
+        std::vector<Uint32> paragraphs;
+        int min_width = 0;
+        int max_width = 0;
+        int line_skip = 0;
+        Uint32 epoch = 0;
+        // The last query, since layout passes tend to ask twice.
+        int last_wrap_width = -1;
+        WrappedSize last_size;
+        std::size_t bytes = 0;
+        std::list<const Key*>::iterator lru;
+    };
+
+    using Map = std::unordered_map<Key, Entry, KeyHash, KeyEqual>;
+
+    struct FontState {
+        Uint32 generation;
+        TTF_FontStyleFlags style;
+        int outline;
+        Uint32 epoch;
+    };
+
+    Uint32 epoch_for(TTF_Font* font);
+    Entry* find(TTF_Font* font, std::string_view text);
+    static bool build(TTF_Font* font, std::string_view text, Entry& entry);
+    static int split_lines(TTF_Font* font, std::string_view word, int wrap_width, int& widest);
+    void erase(Map::iterator it);
+    void trim();
+
+    Config config_;
+    Map entries_;
+    std::list<const Key*> lru_;
+    std::unordered_map<TTF_Font*, FontState> fonts_;
+    std::size_t bytes_ = 0;
+};
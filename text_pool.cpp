@@ -0,0 +1,140 @@
+
+#include "text_pool.hpp"
+
+#include "text_stats.hpp"
+
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+
+int texture_side(int size) {
+    return static_cast<int>(std::bit_ceil(static_cast<unsigned>(std::max(size, 16))));
+}
+
+} // namespace
+
+TextPool::TextPool(TTF_TextEngine* engine)
+    : TextPool(engine, Config{}) {}
+
+TextPool::TextPool(TTF_TextEngine* engine, Config config)
+    : engine_(engine), config_(config) {}
+
+TextPool::~TextPool() {
+    for (const std::vector<TTF_Text*>& texts : spare_texts_) {
+        for (TTF_Text* text : texts) {
+            TTF_DestroyText(text);
+        }
+    }
+    for (const SpareTexture& spare : spare_textures_) {
+        SDL_DestroyTexture(spare.texture);
+    }
+}
+
+std::size_t TextPool::text_class(std::size_t bytes) {
+    return std::min<std::size_t>(std::bit_width(bytes), text_classes - 1);
+}
+
+TTF_Text* TextPool::acquire(TTF_Font* font, std::string_view text) {
+    TtfTimer timer;
+    // The smallest class that fits, else the largest smaller one, whose
+    // buffers then grow once.
+    const std::size_t wanted = text_class(text.size());
+    std::vector<TTF_Text*>* bucket = nullptr;
+    for (std::size_t i = wanted; i < text_classes && bucket == nullptr; ++i) {
+        if (!spare_texts_[i].empty()) {
+            bucket = &spare_texts_[i];
+        }
+    }
+    for (std::size_t i = wanted; i > 0 && bucket == nullptr; --i) {
+        if (!spare_texts_[i - 1].empty()) {
+            bucket = &spare_texts_[i - 1];
+        }
+    }
+    if (bucket == nullptr) {
+        return TTF_CreateText(engine_, font, text.data(), text.size());
+    }
+    TTF_Text* reused = bucket->back();
+    bucket->pop_back();
+    --spare_text_count_;
+    if (TTF_GetTextFont(reused) != font) {
+        TTF_SetTextFont(reused, font);
+    }
+    TTF_SetTextWrapWidth(reused, 0);
+    TTF_SetTextColor(reused, 255, 255, 255, 255);
+    TTF_SetTextString(reused, text.data(), text.size());
+    return reused;
+}
+
+void TextPool::release(TTF_Text* text) {
+    if (text == nullptr) {
+        return;
+    }
+    if (spare_text_count_ >= config_.max_spare_texts) {
+        TTF_DestroyText(text);
+        return;
+    }
+    const std::size_t bytes = text->text != nullptr ? std::strlen(text->text) : 0;
+    spare_texts_[text_class(bytes)].push_back(text);
+    ++spare_text_count_;
+}
+
+SDL_Texture* TextPool::acquire_texture(SDL_Renderer* renderer, SDL_PixelFormat format, SDL_TextureAccess access, int w, int h) {
+    const TextureClass size_class{renderer, format, access, texture_side(w), texture_side(h)};
+    const auto spare = std::find_if(spare_textures_.begin(), spare_textures_.end(), [&](const SpareTexture& s) { return s.size_class == size_class; });
+    SDL_Texture* texture = nullptr;
+    if (spare != spare_textures_.end()) {
+        texture = spare->texture;
+        *spare = spare_textures_.back();
+        spare_textures_.pop_back();
+    } else {
+        texture = SDL_CreateTexture(renderer, format, access, size_class.w, size_class.h);
+        if (texture == nullptr) {
+            return nullptr;
+        }
+    }
+    issued_.insert_or_assign(texture, size_class);
+    return texture;
+}
+
+void TextPool::release_texture(SDL_Texture* texture) {
+    const auto it = issued_.find(texture);
+    if (it == issued_.end()) {
+        SDL_Log("TextPool: released a texture the pool did not hand out");
+        return;
+    }
+    const TextureClass size_class = it->second;
+    issued_.erase(it);
+    if (spare_textures_.size() >= config_.max_spare_textures) {
+        SDL_DestroyTexture(texture);
+        return;
+    }
+    spare_textures_.push_back(SpareTexture{texture, size_class});
+}
+
+DynamicLabel::DynamicLabel(TextPool& pool, TTF_Font* font)
+    : pool_(pool), font_(font) {}
+
+DynamicLabel::~DynamicLabel() {
+    pool_.release(text_);
+}
+
+bool DynamicLabel::set(std::string_view text) {
+    if (text_ != nullptr && text == string_) {
+        return true;
+    }
+    if (text_ == nullptr) {
+        text_ = pool_.acquire(font_, text);
+        if (text_ == nullptr) {
+            return false;
+        }
+    } else {
+        TtfTimer timer;
+        TTF_SetTextString(text_, text.data(), text.size());
+    }
+    string_.assign(text);
+    return true;
+}
@@ -0,0 +1,108 @@
+
+#pragma once
+
+#include <SDL3/SDL_render.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Recycles TTF_Text objects of one text engine and SDL textures, so labels
+// whose content changes every frame (timers, counters, FPS readouts) stop
+// creating and destroying them. Released texts keep their internal buffers
+// and are handed out again with TTF_SetTextString. They are kept by size
+// class, the bit length of their string's byte count, so a long string gets
+// a text whose buffers already fit it. Textures are kept by format, access
+// and power-of-two size.
+//
+// Render thread only, like the engine. At most max_spare_texts texts and
+// max_spare_textures textures are kept; releases beyond that destroy.
+class TextPool {
+public:
+    struct Config {
+        std::size_t max_spare_texts = 64;
+        std::size_t max_spare_textures = 16;
+    };
+
+    explicit TextPool(TTF_TextEngine* engine);
+    TextPool(TTF_TextEngine* engine, Config config);
+    // Destroys the spares. Texts and textures still handed out are the
+    // caller's to release or destroy.
+    ~TextPool();
+
+    TextPool(const TextPool&) = delete;
+    TextPool& operator=(const TextPool&) = delete;
+
+    // A text for the pool's engine showing text with font, with no wrap
+    // width and white color. Returns nullptr with the SDL error set if a
+    // new text could not be created.
+    TTF_Text* acquire(TTF_Font* font, std::string_view text);
+    void release(TTF_Text* text);
+
+    // A texture at least w x h, rounded up to a power of two on each side
+    // (16 minimum); draw from its top-left w x h. Returns nullptr with the
+    // SDL error set if a new texture could not be created.
+    SDL_Texture* acquire_texture(SDL_Renderer* renderer, SDL_PixelFormat format, SDL_TextureAccess access, int w, int h);
+    // texture must have come from acquire_texture().
+    void release_texture(SDL_Texture* texture);
+
+    std::size_t spare_texts() const { return spare_text_count_; }
+    std::size_t spare_textures() const { return spare_textures_.size(); }
+
+private:
+    struct TextureClass {
+        SDL_Renderer* renderer;
+        SDL_PixelFormat format;
+        SDL_TextureAccess access;
+        int w;
+        int h;
+
+        bool operator==(const TextureClass&) const = default;
+    };
+
+    struct SpareTexture {
+        SDL_Texture* texture;
+        TextureClass size_class;
+    };
+
+    static constexpr std::size_t text_classes = 24;
+
+    static std::size_t text_class(std::size_t bytes);
+
+    TTF_TextEngine* engine_;
+    Config config_;
+    std::array<std::vector<TTF_Text*>, text_classes> spare_texts_;
+    std::size_t spare_text_count_ = 0;
+    std::vector<SpareTexture> spare_textures_;
+    // Textures handed out, with the class they go back to.
+    std::unordered_map<SDL_Texture*, TextureClass> issued_;
+};
+
+// A label that keeps one pooled TTF_Text and updates it in place, and only
+// when the string actually changes. In steady state, e.g. a clock redrawn
+// at 144 Hz, set() allocates nothing.
+class DynamicLabel {
+public:
+    DynamicLabel(TextPool& pool, TTF_Font* font);
+    ~DynamicLabel();
+
+    DynamicLabel(const DynamicLabel&) = delete;
+    DynamicLabel& operator=(const DynamicLabel&) = delete;
+
+    // Returns false if the text could not be created.
+    bool set(std::string_view text);
+
+    // nullptr until the first successful set().
+    TTF_Text* text() const { return text_; }
+    std::string_view string() const { return string_; }
+
+private:
+    TextPool& pool_;
+    TTF_Font* font_;
+    TTF_Text* text_ = nullptr;
+    std::string string_;
+};
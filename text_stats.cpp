@@ -0,0 +1,62 @@
+
+#include "text_stats.hpp"
+
+#include "glyph_atlas.hpp"
+#include "shaped_run_cache.hpp"
+
+#include <SDL3/SDL_timer.h>
+
+#include <cstdio>
+
+namespace {
+
+double percent(Uint64 part, Uint64 whole) {
+    return whole != 0 ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+} // namespace
+
+double TextStats::ttf_ms() const {
+    return static_cast<double>(ttf_ticks) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+TextStats& text_stats() {
+    thread_local TextStats stats;
+    return stats;
+}
+
+TextStats end_stats_frame() {
+    TextStats& stats = text_stats();
+    const TextStats frame = stats;
+    stats = TextStats{};
+    return frame;
+}
+
+TtfTimer::TtfTimer()
+    : start_(SDL_GetPerformanceCounter()) {}
+
+TtfTimer::~TtfTimer() {
+    text_stats().ttf_ticks += SDL_GetPerformanceCounter() - start_;
+}
+
+void draw_stats_overlay(SDL_Renderer* renderer, const TextStats& frame, const GlyphAtlas& atlas, const ShapedRunCache& runs, float x, float y) {
+    char lines[6][96];
+    std::snprintf(lines[0], sizeof(lines[0]), "glyphs  %llu hit %llu miss (%.1f%%)", static_cast<unsigned long long>(frame.glyph_hits), static_cast<unsigned long long>(frame.glyph_misses),
+                  percent(frame.glyph_hits, frame.glyph_hits + frame.glyph_misses));
+    std::snprintf(lines[1], sizeof(lines[1]), "runs    %llu hit %llu miss (%.1f%%)", static_cast<unsigned long long>(frame.run_hits), static_cast<unsigned long long>(frame.run_misses),
+                  percent(frame.run_hits, frame.run_hits + frame.run_misses));
+    std::snprintf(lines[2], sizeof(lines[2]), "draws   %llu calls %llu vertices", static_cast<unsigned long long>(frame.draw_calls), static_cast<unsigned long long>(frame.vertices));
+    std::snprintf(lines[3], sizeof(lines[3]), "upload  %.1f KiB  ttf %.3f ms", static_cast<double>(frame.bytes_uploaded) / 1024.0, frame.ttf_ms());
+    std::snprintf(lines[4], sizeof(lines[4]), "atlas   %d pages %zu glyphs %.1f%% used", atlas.live_page_count(), atlas.glyph_count(), atlas.occupancy() * 100.0);
+    std::snprintf(lines[5], sizeof(lines[5]), "cache   %zu runs %.1f KiB", runs.run_count(), static_cast<double>(runs.memory_used()) / 1024.0);
+
+    constexpr float line_height = 10.0f;
+    const SDL_FRect panel{x, y, 8.0f * 48.0f + 8.0f, line_height * 6.0f + 8.0f};
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    SDL_RenderFillRect(renderer, &panel);
+    SDL_SetRenderDrawColor(renderer, 160, 255, 160, 255);
+    for (int i = 0; i < 6; ++i) {
+        SDL_RenderDebugText(renderer, x + 4.0f, y + 4.0f + line_height * static_cast<float>(i), lines[i]);
+    }
+}
@@ -0,0 +1,54 @@
+
+#pragma once
+
+#include <SDL3/SDL_render.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <cstddef>
+
+class GlyphAtlas;
+class ShapedRunCache;
+
+// Counters for the text pipeline, accumulated per thread so recording costs
+// a plain increment. The render thread reads its own with
+// end_stats_frame() once per frame; work done on loader or bulk render
+// threads is counted on those threads and does not show up there.
+struct TextStats {
+    Uint64 glyph_hits = 0;
+    Uint64 glyph_misses = 0;
+    Uint64 run_hits = 0;
+    Uint64 run_misses = 0;
+    Uint64 draw_calls = 0;
+    Uint64 vertices = 0;
+    Uint64 bytes_uploaded = 0;
+    // Performance counter ticks spent inside TTF_* calls.
+    Uint64 ttf_ticks = 0;
+
+    double ttf_ms() const;
+};
+
+// This thread's counters for the frame in progress.
+TextStats& text_stats();
+
+// Returns this thread's counters and starts a new frame.
+TextStats end_stats_frame();
+
+// Adds the time until the end of the scope to text_stats().ttf_ticks. Wrap
+// the TTF calls of a code path, not the work around them.
+class TtfTimer {
+public:
+    TtfTimer();
+    ~TtfTimer();
+
+    TtfTimer(const TtfTimer&) = delete;
+    TtfTimer& operator=(const TtfTimer&) = delete;
+
+private:
+    Uint64 start_;
+};
+
+// Draws frame counters plus atlas and shaped-run cache occupancy in a
+// panel about 400x70 pixels with its top-left corner at (x, y). Uses SDL's
+// debug font so drawing the overlay does not disturb the atlas it reports
+// on.
+void draw_stats_overlay(SDL_Renderer* renderer, const TextStats& frame, const GlyphAtlas& atlas, const ShapedRunCache& runs, float x, float y);
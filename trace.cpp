@@ -0,0 +1,170 @@
+
+#include "trace.hpp"
+
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    SDL_ThreadID thread;
+    Uint64 start;
+    Uint64 duration;
+    int depth;
+    bool instant;
+};
+
+// Keeps a runaway per-frame scope from growing the trace without bound.
+constexpr std::size_t max_events = 1 << 20;
+
+struct TraceState {
+    std::atomic<bool> enabled{false};
+    bool to_stdout = false;
+    std::string path;
+    Uint64 epoch = 0;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+};
+
+TraceState& state() {
+    static TraceState trace;
+    return trace;
+}
+
+thread_local int depth = 0;
+
+void record(const TraceEvent& event) {
+    TraceState& trace = state();
+    std::lock_guard lock(trace.mutex);
+    if (trace.events.size() < max_events) {
+        trace.events.push_back(event);
+    }
+}
+
+double to_us(Uint64 ticks) {
+    return static_cast<double>(ticks) * 1e6 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+void write_json_string(std::FILE* file, const char* text) {
+    std::fputc('"', file);
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(*c, file);
+    }
+    std::fputc('"', file);
+}
+
+void write_stdout(const TraceState& trace, std::vector<TraceEvent>& events) {
+    std::stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+        return a.thread != b.thread ? a.thread < b.thread : a.start < b.start;
+    });
+    SDL_ThreadID thread = 0;
+    for (const TraceEvent& event : events) {
+        if (event.thread != thread) {
+            thread = event.thread;
+            std::printf("trace: thread %llu\n", static_cast<unsigned long long>(thread));
+        }
+        const double at_ms = to_us(event.start - trace.epoch) / 1000.0;
+        if (event.instant) {
+            std::printf("trace: %*s%s at %.3f ms\n", event.depth * 2, "", event.name, at_ms);
+        } else {
+            std::printf("trace: %*s%s %.3f ms (at %.3f ms)\n", event.depth * 2, "", event.name, to_us(event.duration) / 1000.0, at_ms);
+        }
+    }
+    std::fflush(stdout);
+}
+
+void write_chrome_trace(const TraceState& trace, const std::vector<TraceEvent>& events) {
+    std::FILE* file = std::fopen(trace.path.c_str(), "w");
+    if (file == nullptr) {
+        SDL_Log("trace: cannot write %s", trace.path.c_str());
+        return;
+    }
+    std::fputs("{\"traceEvents\":[\n", file);
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent& event = events[i];
+        std::fputs("{\"name\":", file);
+        write_json_string(file, event.name);
+        if (event.instant) {
+            std::fprintf(file, ",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f", to_us(event.start - trace.epoch));
+        } else {
+            std::fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", to_us(event.start - trace.epoch), to_us(event.duration));
+        }
+        std::fprintf(file, ",\"pid\":1,\"tid\":%llu}%s\n", static_cast<unsigned long long>(event.thread), i + 1 < events.size() ? "," : "");
+    }
+    std::fputs("]}\n", file);
+    std::fclose(file);
+}
+
+} // namespace
+
+void trace_init() {
+    TraceState& trace = state();
+    trace.epoch = SDL_GetPerformanceCounter();
+    const char* target = std::getenv("EXAMPLE_TRACE");
+    if (target == nullptr || *target == '\0') {
+        return;
+    }
+    trace.to_stdout = std::strcmp(target, "stdout") == 0 || std::strcmp(target, "1") == 0;
+    if (!trace.to_stdout) {
+        trace.path = target;
+    }
+    trace.enabled.store(true, std::memory_order_release);
+}
+
+bool trace_enabled() {
+    return state().enabled.load(std::memory_order_relaxed);
+}
+
+void trace_instant(const char* name) {
+    if (!trace_enabled()) {
+        return;
+    }
+    record(TraceEvent{name, SDL_GetCurrentThreadID(), SDL_GetPerformanceCounter(), 0, depth, true});
+}
+
+void trace_flush() {
+    if (!trace_enabled()) {
+        return;
+    }
+    TraceState& trace = state();
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard lock(trace.mutex);
+        events.swap(trace.events);
+    }
+    if (trace.to_stdout) {
+        write_stdout(trace, events);
+    } else {
+        write_chrome_trace(trace, events);
+    }
+}
+
+TraceScope::TraceScope(const char* name)
+    : name_(name), start_(0) {
+    if (trace_enabled()) {
+        start_ = SDL_GetPerformanceCounter();
+        ++depth;
+    }
+}
+
+TraceScope::~TraceScope() {
+    if (start_ == 0) {
+        return;
+    }
+    --depth;
+    record(TraceEvent{name_, SDL_GetCurrentThreadID(), start_, SDL_GetPerformanceCounter() - start_, depth, false});
+}
@@ -0,0 +1,41 @@
+
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+// Lightweight scoped timing for startup and per-frame phases, based on
+// SDL_GetPerformanceCounter. Tracing is off unless the EXAMPLE_TRACE
+// environment variable is set: "stdout" (or "1") prints a nested summary
+// when trace_flush() runs, anything else is a path that receives a
+// Chrome trace (chrome://tracing, Perfetto) JSON file.
+//
+// Scopes may be recorded from any thread. When tracing is off a scope costs
+// one branch.
+
+// Reads EXAMPLE_TRACE and sets time zero. Call first thing in main().
+void trace_init();
+bool trace_enabled();
+
+// Records a zero-length marker such as "first_present".
+void trace_instant(const char* name);
+
+// Writes out everything recorded so far and clears it.
+void trace_flush();
+
+class TraceScope {
+public:
+    // name must outlive the trace, in practice a string literal.
+    explicit TraceScope(const char* name);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    Uint64 start_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
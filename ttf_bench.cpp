@@ -0,0 +1,580 @@
+
+#include "blit_kernels.hpp"
+#include "bulk_render.hpp"
+#include "font_fallback.hpp"
+#include "font_manager.hpp"
+#include "glyph_atlas.hpp"
+#include "glyph_raster.hpp"
+#include "glyph_upload_queue.hpp"
+#include "shaped_run_cache.hpp"
+#include "skyline_packer.hpp"
+#include "text_batch.hpp"
+#include "text_layout.hpp"
+#include "text_measure.hpp"
+#include "text_pool.hpp"
+#include "utf8.hpp"
+
+#include <SDL3/SDL_init.h>
+#include <SDL3/SDL_render.h>
+#include <SDL3/SDL_surface.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Fonts come from the environment since none ship with the repo:
+//   TTF_BENCH_FONT_LATIN, TTF_BENCH_FONT_CJK, TTF_BENCH_FONT_ARABIC
+// Benchmarks for a script whose font is not set are skipped.
+
+namespace {
+
+enum class Script {
+    latin,
+    cjk,
+    arabic,
+};
+
+const char* font_path(Script script) {
+    switch (script) {
+    case Script::latin:
+        return std::getenv("TTF_BENCH_FONT_LATIN");
+    case Script::cjk:
+        return std::getenv("TTF_BENCH_FONT_CJK");
+    case Script::arabic:
+        return std::getenv("TTF_BENCH_FONT_ARABIC");
+    }
+    return nullptr;
+}
+
+std::string_view sample_text(Script script) {
+    switch (script) {
+    case Script::latin:
+        return "The quick brown fox jumps over the lazy dog 0123456789";
+    case Script::cjk:
+        return "\xe6\x88\x91\xe8\x83\xbd\xe5\x90\x9e\xe4\xb8\x8b\xe7\x8e\xbb\xe7\x92\x83\xe8\x80\x8c\xe4\xb8\x8d\xe4\xbc\xa4\xe8\xba\xab\xe4\xbd\x93\xe3\x80\x82"
+               "\xe6\x95\xb0\xe6\x8d\xae\xe5\xba\x93\xe8\xbf\x9e\xe6\x8e\xa5\xe5\xb7\xb2\xe6\x96\xad\xe5\xbc\x80";
+    case Script::arabic:
+        return "\xd8\xa3\xd9\x86\xd8\xa7 \xd9\x82\xd8\xa7\xd8\xaf\xd8\xb1 \xd8\xb9\xd9\x84\xd9\x89 \xd8\xa3\xd9\x83\xd9\x84 "
+               "\xd8\xa7\xd9\x84\xd8\xb2\xd8\xac\xd8\xa7\xd8\xac \xd9\x88 \xd9\x87\xd8\xb0\xd8\xa7 \xd9\x84\xd8\xa7 \xd9\x8a\xd8\xa4\xd9\x84\xd9\x85\xd9\x86\xd9\x8a";
+    }
+    return {};
+}
+
+std::vector<Uint32> codepoints(std::string_view text) {
+    std::vector<Uint32> result;
+    for (std::size_t pos = 0; pos < text.size();) {
+        result.push_back(utf8_next(text, pos));
+    }
+    return result;
+}
+
+// Opens the script's font for one benchmark run and closes it afterwards.
+class BenchFont {
+public:
+    BenchFont(benchmark::State& state, Script script, float size) {
+        const char* path = font_path(script);
+        if (path == nullptr) {
+            state.SkipWithError("font for this script not set, see ttf_bench.cpp");
+            return;
+        }
+        font_ = TTF_OpenFont(path, size);
+        if (font_ == nullptr) {
+            state.SkipWithError(SDL_GetError());
+        }
+    }
+
+    ~BenchFont() {
+        if (font_ != nullptr) {
+            TTF_CloseFont(font_);
+        }
+    }
+
+    BenchFont(const BenchFont&) = delete;
+    BenchFont& operator=(const BenchFont&) = delete;
+
+    TTF_Font* get() const { return font_; }
+    explicit operator bool() const { return font_ != nullptr; }
+
+private:
+    TTF_Font* font_ = nullptr;
+};
+
+// A renderer drawing into a plain surface, so batch submission can be timed
+// without a window or video driver.
+class SoftwareTarget {
+public:
+    SoftwareTarget()
+        : surface_(SDL_CreateSurface(1920, 1080, SDL_PIXELFORMAT_ARGB8888)),
+          renderer_(surface_ != nullptr ? SDL_CreateSoftwareRenderer(surface_) : nullptr) {}
+
+    ~SoftwareTarget() {
+        if (renderer_ != nullptr) {
+            SDL_DestroyRenderer(renderer_);
+        }
+        SDL_DestroySurface(surface_);
+    }
+
+    SoftwareTarget(const SoftwareTarget&) = delete;
+    SoftwareTarget& operator=(const SoftwareTarget&) = delete;
+
+    SDL_Renderer* renderer() const { return renderer_; }
+
+private:
+    SDL_Surface* surface_;
+    SDL_Renderer* renderer_;
+};
+
+float point_size(const benchmark::State& state) {
+    return static_cast<float>(state.range(0));
+}
+
+void BM_FontOpenClose(benchmark::State& state, Script script) {
+    const char* path = font_path(script);
+    if (path == nullptr) {
+        state.SkipWithError("font for this script not set, see ttf_bench.cpp");
+        return;
+    }
+    for (auto _ : state) {
+        TTF_Font* font = TTF_OpenFont(path, point_size(state));
+        if (font == nullptr) {
+            state.SkipWithError(SDL_GetError());
+            return;
+        }
+        TTF_CloseFont(font);
+    }
+}
+
+// Same as BM_FontOpenClose but through the memory-mapped FontManager path,
+// with the mapping kept warm by a face left open for the whole run.
+void BM_FontOpenCloseMapped(benchmark::State& state, Script script) {
+    const char* path = font_path(script);
+    if (path == nullptr) {
+        state.SkipWithError("font for this script not set, see ttf_bench.cpp");
+        return;
+    }
+    FontManager fonts;
+    const FontHandle warm = fonts.open(path, point_size(state));
+    if (!warm) {
+        state.SkipWithError(SDL_GetError());
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fonts.open_exclusive(path, point_size(state)));
+    }
+}
+
+// Asking the manager for a size it already has, or for a new size of an
+// open face, instead of opening the file again.
+void BM_FontManagerSizeVariant(benchmark::State& state, Script script) {
+    const char* path = font_path(script);
+    if (path == nullptr) {
+        state.SkipWithError("font for this script not set, see ttf_bench.cpp");
+        return;
+    }
+    FontManager fonts;
+    const FontHandle warm = fonts.open(path, 16.0f);
+    if (!warm) {
+        state.SkipWithError(SDL_GetError());
+        return;
+    }
+    for (auto _ : state) {
+        const FontHandle handle = fonts.open(path, point_size(state));
+        benchmark::DoNotOptimize(handle.get());
+    }
+}
+
+// Uncached glyph rasterization, the cost every atlas miss pays.
+void BM_RasterizeGlyphs(benchmark::State& state, Script script) {
+    BenchFont font(state, script, point_size(state));
+    if (!font) {
+        return;
+    }
+    const std::vector<Uint32> glyphs = codepoints(sample_text(script));
+    for (auto _ : state) {
+        for (Uint32 codepoint : glyphs) {
+            GlyphBitmap bitmap;
+            rasterize_glyph(font.get(), codepoint, bitmap);
+            benchmark::DoNotOptimize(bitmap.ink);
+            SDL_DestroySurface(bitmap.surface);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(glyphs.size()));
+}
+
+// Whole-string rendering, the naive per-label path the atlas replaces.
+void BM_RenderTextBlended(benchmark::State& state, Script script) {
+    BenchFont font(state, script, point_size(state));
+    if (!font) {
+        return;
+    }
+    const std::string_view text = sample_text(script);
+    for (auto _ : state) {
+        SDL_Surface* surface = TTF_RenderText_Blended(font.get(), text.data(), text.size(), SDL_Color{255, 255, 255, 255});
+        benchmark::DoNotOptimize(surface);
+        SDL_DestroySurface(surface);
+    }
+}
+
+void BM_GetStringSize(benchmark::State& state, Script script) {
+    BenchFont font(state, script, point_size(state));
+    if (!font) {
+        return;
+    }
+    const std::string_view text = sample_text(script);
+    for (auto _ : state) {
+        int w = 0;
+        int h = 0;
+        TTF_GetStringSize(font.get(), text.data(), text.size(), &w, &h);
+        benchmark::DoNotOptimize(w);
+    }
+}
+
+void BM_ShapedRunCacheHit(benchmark::State& state, Script script) {
+    BenchFont font(state, script, point_size(state));
+    if (!font) {
+        return;
+    }
+    const std::string_view text = sample_text(script);
+    ShapedRunCache runs;
+    runs.shape(font.get(), text);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(runs.shape(font.get(), text));
+    }
+}
+
+// Resolves the font of every codepoint in mixed Latin/CJK/Arabic text over a
+// Latin -> CJK -> Arabic chain; arg 0 probes TTF_FontHasGlyph font by font,
+// arg 1 uses FontFallback's page table.
+void BM_FontFallbackResolve(benchmark::State& state) {
+    const char* latin = font_path(Script::latin);
+    const char* cjk = font_path(Script::cjk);
+    const char* arabic = font_path(Script::arabic);
+    if (latin == nullptr || cjk == nullptr || arabic == nullptr) {
+        state.SkipWithError("fonts for all scripts needed, see ttf_bench.cpp");
+        return;
+    }
+    FontManager fonts;
+    std::vector<FontHandle> chain{fonts.open(latin, 16.0f), fonts.open(cjk, 16.0f), fonts.open(arabic, 16.0f)};
+    if (!chain[0] || !chain[1] || !chain[2]) {
+        state.SkipWithError(SDL_GetError());
+        return;
+    }
+    std::string text;
+    for (Script script : {Script::latin, Script::cjk, Script::arabic}) {
+        text.append(sample_text(script));
+    }
+    const std::vector<Uint32> cps = codepoints(text);
+    if (state.range(0) == 0) {
+        std::vector<TTF_Font*> faces{chain[0].get(), chain[1].get(), chain[2].get()};
+        for (auto _ : state) {
+            for (Uint32 cp : cps) {
+                TTF_Font* found = faces[0];
+                for (TTF_Font* face : faces) {
+                    if (TTF_FontHasGlyph(face, cp)) {
+                        found = face;
+                        break;
+                    }
+                }
+                benchmark::DoNotOptimize(found);
+            }
+        }
+    } else {
+        FontFallback fallback(std::move(chain));
+        for (auto _ : state) {
+            for (Uint32 cp : cps) {
+                benchmark::DoNotOptimize(fallback.font_index(cp));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(cps.size()));
+}
+
+// Packs glyph-sized rectangles, starting a new page whenever one fills up.
+// The pages counter is how many pages the sizes took, the packing density.
+void BM_SkylinePack(benchmark::State& state) {
+    std::mt19937 rng(1234);
+    const int max_side = static_cast<int>(state.range(0));
+    std::uniform_int_distribution<int> side(max_side / 3, max_side);
+    std::vector<std::pair<int, int>> sizes(4096);
+    for (auto& size : sizes) {
+        size = {side(rng), side(rng)};
+    }
+    SkylinePacker packer(1024);
+    int pages = 0;
+    for (auto _ : state) {
+        packer.reset();
+        pages = 1;
+        for (const auto& [w, h] : sizes) {
+            SDL_Rect rect;
+            if (!packer.pack(w, h, rect)) {
+                packer.reset();
+                packer.pack(w, h, rect);
+                ++pages;
+            }
+            benchmark::DoNotOptimize(rect);
+        }
+    }
+    state.counters["pages"] = pages;
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(sizes.size()));
+}
+
+// Queues state.range(0) labels through a warm atlas and submits them.
+void BM_TextBatchSubmit(benchmark::State& state) {
+    BenchFont font(state, Script::latin, 16.0f);
+    if (!font) {
+        return;
+    }
+    SoftwareTarget target;
+    if (target.renderer() == nullptr) {
+        state.SkipWithError(SDL_GetError());
+        return;
+    }
+    GlyphAtlas atlas(target.renderer());
+    ShapedRunCache runs;
+    TextBatch batch(atlas, runs);
+    const std::string_view text = sample_text(Script::latin);
+    const auto labels = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        atlas.begin_frame();
+        for (int i = 0; i < labels; ++i) {
+            batch.add(font.get(), text, static_cast<float>(i % 4) * 480.0f, static_cast<float>(i / 4 % 50) * 20.0f, SDL_FColor{1.0f, 1.0f, 1.0f, 1.0f});
+        }
+        benchmark::DoNotOptimize(batch.flush());
+    }
+    state.SetItemsProcessed(state.iterations() * labels);
+}
+
+// Drains a burst of 400 staged glyphs into an empty atlas and flushes it, as
+// after a language switch; arg 0 updates the texture once per glyph, arg 1
+// coalesces into one update per page.
+void BM_GlyphUploadDrain(benchmark::State& state) {
+    BenchFont font(state, Script::latin, 32.0f);
+    if (!font) {
+        return;
+    }
+    SoftwareTarget target;
+    if (target.renderer() == nullptr) {
+        state.SkipWithError(SDL_GetError());
+        return;
+    }
+    GlyphAtlas::Config config;
+    config.coalesce_uploads = state.range(0) != 0;
+    GlyphAtlas atlas(target.renderer(), config);
+    GlyphUploadQueue queue(512);
+    for (auto _ : state) {
+        state.PauseTiming();
+        atlas.clear();
+        for (Uint32 codepoint = 0x21; codepoint < 0x21 + 400; ++codepoint) {
+            queue.stage(font.get(), font.get(), codepoint);
+        }
+        state.ResumeTiming();
+        atlas.begin_frame();
+        benchmark::DoNotOptimize(atlas.drain_uploads(queue, 1000000000));
+        atlas.flush_uploads();
+    }
+    state.SetItemsProcessed(state.iterations() * 400);
+}
+
+// Renders 2000 labels of varying length to surfaces on `threads` workers.
+void BM_RenderLabelsBulk(benchmark::State& state) {
+    const char* path = font_path(Script::latin);
+    if (path == nullptr) {
+        state.SkipWithError("font for this script not set, see ttf_bench.cpp");
+        return;
+    }
+    const std::string_view text = sample_text(Script::latin);
+    std::vector<LabelJob> jobs(2000);
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        jobs[i].text = std::string(text.substr(0, 8 + i % (text.size() - 8)));
+        jobs[i].font_path = path;
+        jobs[i].size = (i % 3 == 0) ? 24.0f : 14.0f;
+    }
+    FontManager fonts;
+    BulkRenderConfig config;
+    config.threads = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        std::vector<SDL_Surface*> surfaces = render_labels(fonts, jobs, config);
+        for (SDL_Surface* surface : surfaces) {
+            SDL_DestroySurface(surface);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(jobs.size()));
+}
+
+// Streams one line into a buffer of `lines` wrapped lines and lays out a
+// screenful scrolled to the bottom, as a log pane does on every append.
+// Should stay flat as the buffer grows.
+void BM_TextLayoutAppend(benchmark::State& state) {
+    BenchFont font(state, Script::latin, 16.0f);
+    if (!font) {
+        return;
+    }
+    TTF_TextEngine* engine = TTF_CreateSurfaceTextEngine();
+    if (engine == nullptr) {
+        state.SkipWithError(SDL_GetError());
+        return;
+    }
+    {
+        TextLayout layout(engine, font.get(), 400);
+        std::string line(sample_text(Script::latin));
+        line.insert(0, "\n");
+        const auto lines = static_cast<int>(state.range(0));
+        for (int i = 0; i < lines; ++i) {
+            layout.append(line);
+        }
+        for (auto _ : state) {
+            layout.append(line);
+            const auto bottom = static_cast<float>(layout.content_height());
+            benchmark::DoNotOptimize(layout.layout_visible(bottom - 1080.0f, 1080.0f).size());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    TTF_DestroySurfaceTextEngine(engine);
+}
+
+// A counter label whose text changes every frame; arg 0 creates and
+// destroys a TTF_Text per change, arg 1 updates a DynamicLabel in place.
+void BM_DynamicLabel(benchmark::State& state) {
+    BenchFont font(state, Script::latin, 16.0f);
+    if (!font) {
+        return;
+    }
+    TTF_TextEngine* engine = TTF_CreateSurfaceTextEngine();
+    if (engine == nullptr) {
+        state.SkipWithError(SDL_GetError());
+        return;
+    }
+    {
+        const bool pooled = state.range(0) != 0;
+        TextPool pool(engine);
+        DynamicLabel label(pool, font.get());
+        char buffer[32];
+        int frame = 0;
+        for (auto _ : state) {
+            const int length = std::snprintf(buffer, sizeof(buffer), "frame %06d", frame++ % 1000000);
+            const std::string_view text(buffer, static_cast<std::size_t>(length));
+            int w = 0;
+            int h = 0;
+            if (pooled) {
+                label.set(text);
+                TTF_GetTextSize(label.text(), &w, &h);
+            } else {
+                TTF_Text* created = TTF_CreateText(engine, font.get(), text.data(), text.size());
+                TTF_GetTextSize(created, &w, &h);
+                TTF_DestroyText(created);
+            }
+            benchmark::DoNotOptimize(w);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    TTF_DestroySurfaceTextEngine(engine);
+}
+
+// Measures a paragraph at the eight widths a layout pass tries while
+// shrinking a box; arg 0 calls TTF_GetStringSizeWrapped each time, arg 1
+// asks TextMeasureCache.
+void BM_WrappedSize(benchmark::State& state) {
+    BenchFont font(state, Script::latin, 16.0f);
+    if (!font) {
+        return;
+    }
+    std::string text;
+    for (int i = 0; i < 8; ++i) {
+        text.append(sample_text(Script::latin)).append(" ");
+    }
+    const bool cached = state.range(0) != 0;
+    TextMeasureCache measures;
+    for (auto _ : state) {
+        for (int wrap_width = 800; wrap_width > 0; wrap_width -= 100) {
+            int w = 0;
+            int h = 0;
+            if (cached) {
+                WrappedSize size;
+                measures.wrapped_size(font.get(), text, wrap_width, size);
+                h = size.height;
+            } else {
+                TTF_GetStringSizeWrapped(font.get(), text.data(), text.size(), wrap_width, &w, &h);
+            }
+            benchmark::DoNotOptimize(h);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 8);
+}
+
+// Blends a 64x64 glyph-sized block over a destination; arg 0 runs the
+// scalar kernels, arg 1 whatever blit_kernels() picked for this CPU.
+void BM_BlitCoverage(benchmark::State& state) {
+    const BlitKernels& kernels = state.range(0) == 0 ? scalar_blit_kernels() : blit_kernels();
+    state.SetLabel(kernels.name);
+    std::mt19937 rng(1234);
+    std::vector<Uint8> coverage(64 * 64);
+    for (Uint8& value : coverage) {
+        value = static_cast<Uint8>(rng());
+    }
+    std::vector<Uint32> dst(64 * 64, 0xFF101018u);
+    for (auto _ : state) {
+        kernels.coverage(coverage.data(), 64, dst.data(), 64 * 4, 64, 64, SDL_Color{200, 220, 255, 255});
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(coverage.size() * 5));
+}
+
+void BM_BlitArgb(benchmark::State& state) {
+    const BlitKernels& kernels = state.range(0) == 0 ? scalar_blit_kernels() : blit_kernels();
+    state.SetLabel(kernels.name);
+    std::mt19937 rng(1234);
+    std::vector<Uint32> src(64 * 64);
+    for (Uint32& value : src) {
+        value = static_cast<Uint32>(rng());
+    }
+    std::vector<Uint32> dst(64 * 64, 0xFF101018u);
+    for (auto _ : state) {
+        kernels.argb(src.data(), 64 * 4, dst.data(), 64 * 4, 64, 64, SDL_Color{200, 220, 255, 255});
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(src.size() * 8));
+}
+
+#define SCRIPT_BENCHMARK(fn)                                                              \
+    BENCHMARK_CAPTURE(fn, latin, Script::latin)->Arg(12)->Arg(24)->Arg(48)->ArgName("pt"); \
+    BENCHMARK_CAPTURE(fn, cjk, Script::cjk)->Arg(12)->Arg(24)->Arg(48)->ArgName("pt");     \
+    BENCHMARK_CAPTURE(fn, arabic, Script::arabic)->Arg(12)->Arg(24)->Arg(48)->ArgName("pt")
+
+SCRIPT_BENCHMARK(BM_FontOpenClose);
+SCRIPT_BENCHMARK(BM_FontOpenCloseMapped);
+SCRIPT_BENCHMARK(BM_FontManagerSizeVariant);
+SCRIPT_BENCHMARK(BM_RasterizeGlyphs);
+SCRIPT_BENCHMARK(BM_RenderTextBlended);
+SCRIPT_BENCHMARK(BM_GetStringSize);
+SCRIPT_BENCHMARK(BM_ShapedRunCacheHit);
+BENCHMARK(BM_FontFallbackResolve)->Arg(0)->Arg(1)->ArgName("table");
+BENCHMARK(BM_SkylinePack)->Arg(16)->Arg(32)->Arg(64)->ArgName("max_side");
+BENCHMARK(BM_BlitCoverage)->Arg(0)->Arg(1)->ArgName("simd");
+BENCHMARK(BM_BlitArgb)->Arg(0)->Arg(1)->ArgName("simd");
+BENCHMARK(BM_TextBatchSubmit)->Arg(100)->Arg(1000)->Arg(10000)->ArgName("labels");
+BENCHMARK(BM_GlyphUploadDrain)->Arg(0)->Arg(1)->ArgName("coalesce");
+BENCHMARK(BM_RenderLabelsBulk)->Arg(1)->Arg(4)->Arg(16)->ArgName("threads")->UseRealTime();
+BENCHMARK(BM_DynamicLabel)->Arg(0)->Arg(1)->ArgName("pooled");
+BENCHMARK(BM_WrappedSize)->Arg(0)->Arg(1)->ArgName("cached");
+BENCHMARK(BM_TextLayoutAppend)->Arg(1000)->Arg(100000)->ArgName("lines");
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    SDL_Init(0);
+    TTF_Init();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    TTF_Quit();
+    SDL_Quit();
+    return 0;
+}
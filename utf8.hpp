@@ -0,0 +1,47 @@
+
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <cstddef>
+#include <string_view>
+
+// Decodes the codepoint starting at text[pos] and advances pos past it.
+// Malformed sequences decode to U+FFFD and consume a single byte.
+inline Uint32 utf8_next(std::string_view text, std::size_t& pos) {
+    const auto byte = [&](std::size_t i) { return static_cast<Uint8>(text[i]); };
+    const Uint8 lead = byte(pos);
+    if (lead < 0x80) {
+        ++pos;
+        return lead;
+    }
+    int extra = 0;
+    Uint32 cp = 0;
+    if ((lead & 0xE0) == 0xC0) {
+        extra = 1;
+        cp = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        extra = 2;
+        cp = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        extra = 3;
+        cp = lead & 0x07;
+    } else {
+        ++pos;
+        return 0xFFFD;
+    }
+    if (pos + extra >= text.size()) {
+        ++pos;
+        return 0xFFFD;
+    }
+    for (int i = 1; i <= extra; ++i) {
+        const Uint8 cont = byte(pos + i);
+        if ((cont & 0xC0) != 0x80) {
+            ++pos;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (cont & 0x3F);
+    }
+    pos += extra + 1;
+    return cp;
+}